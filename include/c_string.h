@@ -18,14 +18,143 @@
 #define C_STRING_H // Define the macro
 
 #include "arena.h"
+#include "chunk_arena.h"
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Number of bytes (including the null terminator) stored directly inside a `String`.
+ *
+ * Strings whose content is shorter than this live in `inline_data` and never need a separate
+ * data buffer. Longer strings spill to a heap or arena buffer.
+ */
+#define STRING_INLINE_CAPACITY 24
+
+/**
+ * @brief Bits of `String.flags`, set by the string builder pool (see string_pool.h).
+ */
+#define STRING_FLAG_POOLED_HEADER (1u << 0) // The String itself was taken from the thread-local pool
+#define STRING_FLAG_POOLED_DATA (1u << 1)   // data is a buffer of the thread-local pool
+
+/**
+ * @brief Default values of the global `StringGrowthPolicy`.
+ */
+#define STRING_DEFAULT_GROWTH_FACTOR 2.0
+#define STRING_DEFAULT_GROWTH_MIN_STEP 16
+#define STRING_DEFAULT_GROWTH_PAGE_SIZE 4096
+#define STRING_DEFAULT_GROWTH_LARGE_THRESHOLD (64 * 1024)
+
+/**
+ * @brief Controls how much capacity a `String` gains when an append does not fit.
+ *
+ * The policy is global and applies to the malloc, block and arena growth paths alike.
+ */
+typedef struct
+{
+    double factor;          // The current capacity is multiplied by this factor when growing (>= 1.0)
+    size_t min_step;        // Minimum number of bytes added by a single growth
+    size_t page_size;       // Capacities of large strings are rounded up to multiples of this, 0 disables rounding
+    size_t large_threshold; // Capacities at or above this size count as large
+} StringGrowthPolicy;
 
 typedef struct
 {
-    char *data;       // Pointer to the char array (Here we store our string content)
+    char *data;       // Pointer to the char array (Here we store our string content), either inline_data or a separate buffer
     size_t length;    // Current Length of the String excluding the Null Terminator
     size_t capacity;  // Total allocated size of the data buffer
+    uint64_t hash;    // Cached result of string_hash, 0 if not computed since the last modification
+    uint32_t flags;   // STRING_FLAG_* bits, 0 for every string not created by string_builder_acquire
+    char inline_data[STRING_INLINE_CAPACITY]; // Storage for short strings (small-string optimization)
 } String;
 
+/**
+ * @brief A non-owning view of a sequence of bytes, for example a part of a `String`.
+ *
+ * Views never allocate and never write. They stay valid as long as the memory they point to is
+ * neither freed nor moved (appending to the `String` a view was taken from may move its data).
+ * The bytes of a view are not null terminated.
+ */
+typedef struct
+{
+    const char *ptr; // First byte of the view
+    size_t len;      // Number of bytes in the view
+} StringView;
+
+/**
+ * @brief Returned by the search functions when nothing was found.
+ */
+#define STRING_NPOS ((size_t)-1)
+
+/**
+ * @brief How a `StringSplitIterator` recognizes delimiters.
+ */
+typedef enum
+{
+    STRING_SPLIT_CHAR,      // A single delimiter byte
+    STRING_SPLIT_ANY,       // Any byte of a set of delimiter bytes
+    STRING_SPLIT_SUBSTRING, // A delimiter of one or more bytes
+} StringSplitMode;
+
+/**
+ * @brief Iterator over the tokens of a view, created by `string_split_char`, `string_split_any`
+ *        or `string_split_substring` and advanced with `string_split_next`.
+ *
+ * The tokens are views into the input, splitting never allocates.
+ */
+typedef struct
+{
+    StringView rest;       // Part of the input that has not been returned yet
+    StringView delimiter;  // Delimiter set or substring (STRING_SPLIT_ANY, STRING_SPLIT_SUBSTRING)
+    char delimiter_char;   // Delimiter byte (STRING_SPLIT_CHAR)
+    StringSplitMode mode;  // How delimiters are recognized
+    bool done;             // Set after the last token was returned
+} StringSplitIterator;
+
+/**
+ * @brief Iterator over the code points of UTF-8 text, created by `string_utf8_iterate` and
+ *        advanced with `string_utf8_next`.
+ */
+typedef struct
+{
+    StringView rest; // Part of the text that has not been decoded yet
+} StringUtf8Iterator;
+
+/**
+ * @brief Code point returned for invalid UTF-8 sequences.
+ */
+#define STRING_UTF8_REPLACEMENT 0xFFFDu
+
+/**
+ * @brief State of a UTF-16 conversion whose input arrives in several buffers.
+ *
+ * Initialize with `string_utf16_decoder_init`. A surrogate pair split between two buffers is
+ * carried over, so buffers can be cut at any code unit.
+ */
+typedef struct
+{
+    uint16_t pending; // High surrogate that ended the previous buffer, 0 if there is none
+} StringUtf16Decoder;
+
+/**
+ * @brief Outcome of the number parsing functions.
+ */
+typedef enum
+{
+    STRING_PARSE_OK,       // A number was parsed
+    STRING_PARSE_INVALID,  // The input does not start with a number
+    STRING_PARSE_OVERFLOW, // The number does not fit, the value is saturated
+} StringParseStatus;
+
+/**
+ * @brief Result of the number parsing functions.
+ */
+typedef struct
+{
+    size_t consumed;          // Number of bytes that belong to the number, 0 if STRING_PARSE_INVALID
+    StringParseStatus status; // Whether parsing succeeded
+} StringParseResult;
+
 /**
  * @brief Creates a new `String` allocated on the heap (using `malloc`).
  *
@@ -34,6 +163,38 @@ typedef struct
  */
 String *new_string_malloc(const char *inital_str);
 
+/**
+ * @brief Initializes a `String` that lives in caller provided storage (for example on the stack).
+ *
+ * Short contents are kept in the inline buffer, so no allocation happens at all. Longer contents
+ * are copied into a `malloc` allocated buffer that must be released with `string_destroy`.
+ *
+ * @param string The `String` to initialize.
+ * @param initial_str The initial string to copy into the `String`. Can be NULL.
+ * @return `true` on success, `false` if a data buffer was needed and could not be allocated.
+ *
+ * @note Because `data` may point into the struct itself, an initialized `String` must not be
+ *       copied by value. Pass it around by pointer instead.
+ */
+bool string_init(String *string, const char *initial_str);
+
+/**
+ * @brief Releases the data buffer of a `String` initialized with `string_init`.
+ *
+ * The `String` itself is not freed, it is reset to an empty inline string.
+ *
+ * @param string The `String` to destroy.
+ */
+void string_destroy(String *string);
+
+/**
+ * @brief Checks whether the content of a `String` is stored inline (small-string optimization).
+ *
+ * @param string The `String` to inspect.
+ * @return `true` if `string->data` points into the `String` itself.
+ */
+bool string_is_inline(const String *string);
+
 /**
  * @brief Creates a new `String` within a given arena.
  *
@@ -45,11 +206,138 @@ String *new_string_malloc(const char *inital_str);
  * @param arena A pointer to the `Arena` structure where the `String` will be allocated.
  * @return A pointer to the newly created `String`, or NULL if allocation fails.
  *
- * @note  If allocation of either the `String` structure or its string data fails, the arena
- *        will be reset to its state before this function was called.
+ * @note  The `String` structure and its string data are allocated with a single `arena_allocate`
+ *        call. If it fails nothing was allocated and all other strings in the arena stay intact.
  */
 String *new_string_arena(const char *inital_str, Arena *arena);
 
+/**
+ * @brief Creates a new `String` whose header and character data share a single heap allocation.
+ *
+ * The payload is stored directly behind the header (starting at `inline_data`), so creating the
+ * string is one `malloc` call, the length and the first bytes of the content share a cache line
+ * and `string_free` releases everything with one `free` call.
+ *
+ * @param initial_str The initial string to copy into the new `String`. Can be NULL.
+ * @return A pointer to the newly created `String`, or NULL if allocation fails.
+ *
+ * @note Grow block strings with `string_append_char_array_block` or `string_append_string_block`,
+ *       which may move the `String` and return its new address.
+ */
+String *new_string_block(const char *initial_str);
+
+/**
+ * @brief Appends a character array (`char *`) to a `String` created with `new_string_block`.
+ *
+ * If the payload does not fit, the whole block (header and data) is reallocated. The `String`
+ * can therefore move, always continue with the returned pointer.
+ *
+ * @param dest The destination `String` to append to.
+ * @param src The character array to append.
+ * @return The (possibly moved) `String`, or NULL if reallocation fails. On failure `dest` is left
+ *         unchanged and remains valid.
+ */
+String *string_append_char_array_block(String *dest, const char *src);
+
+/**
+ * @brief Appends `src_len` bytes to a `String` created with `new_string_block`.
+ *
+ * @param dest The destination `String` to append to.
+ * @param src The bytes to append, they do not need to be null terminated and may contain '\0'.
+ * @param src_len The number of bytes to append.
+ * @return The (possibly moved) `String`, or NULL if reallocation fails. On failure `dest` is left
+ *         unchanged and remains valid.
+ */
+String *string_append_bytes_block(String *dest, const char *src, size_t src_len);
+
+/**
+ * @brief Appends another `String` to a `String` created with `new_string_block`.
+ *
+ * @param dest The destination `String` to append to.
+ * @param src The source `String` to append.
+ * @return The (possibly moved) `String`, or NULL if reallocation fails. On failure `dest` is left
+ *         unchanged and remains valid.
+ */
+String *string_append_string_block(String *dest, const String *src);
+
+/**
+ * @brief Replaces the global growth policy used when strings need more capacity.
+ *
+ * Lower factors trade more frequent reallocations for less unused memory, which can be useful
+ * for memory-constrained services.
+ *
+ * @param policy The new policy, copied by the function. Pass NULL to restore the defaults.
+ *
+ * @note The policy is not synchronized, set it once before strings are used by multiple threads.
+ */
+void string_set_growth_policy(const StringGrowthPolicy *policy);
+
+/**
+ * @brief Returns a copy of the current global growth policy.
+ */
+StringGrowthPolicy string_get_growth_policy(void);
+
+/**
+ * @brief Makes sure a malloc-allocated `String` can hold at least `capacity` characters without growing.
+ *
+ * The buffer is resized to exactly `capacity + 1` bytes (including the null terminator) if it is
+ * currently smaller. Reserving up front avoids repeated reallocations when the final size is known.
+ *
+ * @param string The `String` to reserve space in.
+ * @param capacity The number of characters (excluding the null terminator) the string should hold.
+ * @return `ARENA_SUCCESS`, or an error if the buffer could not be allocated. On failure the string is unchanged.
+ */
+ArenaError string_reserve_malloc(String *string, size_t capacity);
+
+/**
+ * @brief Makes sure an arena-allocated `String` can hold at least `capacity` characters without growing.
+ *
+ * @param string The `String` to reserve space in.
+ * @param capacity The number of characters (excluding the null terminator) the string should hold.
+ * @param arena A pointer to the `Arena` if `string` is arena-allocated. If NULL, it is assumed that `string` is malloc-allocated.
+ * @return `ARENA_SUCCESS`, or an error if the arena could not provide the memory.
+ */
+ArenaError string_reserve_arena(String *string, size_t capacity, Arena *arena);
+
+/**
+ * @brief Makes sure a `String` allocated from a `ChunkArena` can hold at least `capacity` characters without growing.
+ *
+ * @param string The `String` to reserve space in.
+ * @param capacity The number of characters (excluding the null terminator) the string should hold.
+ * @param arena The `ChunkArena` `string` was allocated from.
+ * @return `ARENA_SUCCESS`, or `ARENA_ERROR_ALLOCATION_FAILED` if no new block could be allocated.
+ */
+ArenaError string_reserve_chunk_arena(String *string, size_t capacity, ChunkArena *arena);
+
+/**
+ * @brief Releases unused capacity of a malloc-allocated `String`.
+ *
+ * Strings short enough for the inline buffer are moved back into it and their heap buffer is
+ * freed, other strings are reallocated to `length + 1` bytes.
+ *
+ * @param string The `String` to shrink.
+ * @return `ARENA_SUCCESS`, or `ARENA_ERROR_REALLOCATION_FAILED` if the buffer could not be
+ *         reallocated. The content stays intact in either case.
+ *
+ * @note Arena strings have nothing to shrink, their memory is reclaimed when the arena is reset.
+ */
+ArenaError string_shrink_to_fit_malloc(String *string);
+
+/**
+ * @brief Creates a new `String` within a `ChunkArena`.
+ *
+ * Unlike `Arena`, a `ChunkArena` never relocates memory it already handed out, so the string and
+ * every other allocation in the arena stay valid while strings grow.
+ *
+ * @param initial_str The initial string to copy into the new `String`. Can be NULL.
+ * @param arena The `ChunkArena` the `String` and its data are allocated from.
+ * @return A pointer to the newly created `String`, or NULL if allocation fails.
+ *
+ * @note  The `String` structure and its string data are allocated in one shot. To undo a group of
+ *        allocations use `chunk_arena_mark` and `chunk_arena_restore`.
+ */
+String *new_string_chunk_arena(const char *initial_str, ChunkArena *arena);
+
 /**
  * @brief Retrieves the character at the specified index in the `String`.
  *
@@ -65,12 +353,65 @@ char string_char_at_index(const String *string, size_t index);
  * This function is used to append a null-terminated character array (`char *`) to the end of an existing `String`. 
  * It handles arena-allocated strings.
  *
+ * When the string is the most recent allocation of the arena it is extended in place. Otherwise its
+ * content is copied into a fresh buffer from the arena, the old bytes are left behind until the
+ * arena is reset. The arena itself is never grown with `arena_grow`, so other strings living in the
+ * same arena are never moved or invalidated.
+ *
  * @param dest The destination `String` to append to.
  * @param src The character array to append.
  * @param arena A pointer to the `Arena` if `dest` is arena-allocated. If NULL, it is assumed that `dest` is malloc-allocated.
  */
 ArenaError string_append_char_array_arena(String *dest, const char *src, Arena *arena); 
 
+/**
+ * @brief Appends `src_len` bytes to an arena-allocated `String`.
+ *
+ * Unlike `string_append_char_array_arena` the source is never scanned with `strlen`, the bytes
+ * are copied with a single `memcpy`. The source may contain embedded null bytes.
+ *
+ * @param dest The destination `String` to append to.
+ * @param src The bytes to append.
+ * @param src_len The number of bytes to append.
+ * @param arena A pointer to the `Arena` if `dest` is arena-allocated. If NULL, it is assumed that `dest` is malloc-allocated.
+ * @return `ARENA_SUCCESS`, or an error if the string could not grow. On failure `dest` is unchanged.
+ */
+ArenaError string_append_bytes_arena(String *dest, const char *src, size_t src_len, Arena *arena);
+
+/**
+ * @brief Appends `src_len` bytes to a `String` allocated from a `ChunkArena`.
+ *
+ * If the string is the most recent allocation of the arena it is extended in place, otherwise its
+ * content is copied into a fresh buffer from the arena. Nothing else in the arena moves.
+ *
+ * @param dest The destination `String` to append to.
+ * @param src The bytes to append.
+ * @param src_len The number of bytes to append.
+ * @param arena The `ChunkArena` `dest` was allocated from.
+ * @return `ARENA_SUCCESS`, or `ARENA_ERROR_ALLOCATION_FAILED` if no new block could be allocated.
+ */
+ArenaError string_append_bytes_chunk_arena(String *dest, const char *src, size_t src_len, ChunkArena *arena);
+
+/**
+ * @brief Appends a character array (`char *`) to a `String` allocated from a `ChunkArena`.
+ *
+ * @param dest The destination `String` to append to.
+ * @param src The character array to append.
+ * @param arena The `ChunkArena` `dest` was allocated from.
+ * @return `ARENA_SUCCESS`, or `ARENA_ERROR_ALLOCATION_FAILED` if no new block could be allocated.
+ */
+ArenaError string_append_char_array_chunk_arena(String *dest, const char *src, ChunkArena *arena);
+
+/**
+ * @brief Appends another `String` to a `String` allocated from a `ChunkArena`.
+ *
+ * @param dest The destination `String` to append to.
+ * @param src The source `String` to append.
+ * @param arena The `ChunkArena` `dest` was allocated from.
+ * @return `ARENA_SUCCESS`, or `ARENA_ERROR_ALLOCATION_FAILED` if no new block could be allocated.
+ */
+ArenaError string_append_string_chunk_arena(String *dest, const String *src, ChunkArena *arena);
+
 /**
  * @brief Appends a character array (`char *`) to a malloc-allocated `String`.
  *
@@ -82,11 +423,25 @@ ArenaError string_append_char_array_arena(String *dest, const char *src, Arena *
  */
 void string_append_char_array_malloc(String *dest, const char *src);
 
+/**
+ * @brief Appends `src_len` bytes to a malloc-allocated `String`.
+ *
+ * Unlike `string_append_char_array_malloc` the source is never scanned with `strlen`, the bytes
+ * are copied with a single `memcpy`. The source may contain embedded null bytes.
+ *
+ * @param dest The destination `String` to append to.
+ * @param src The bytes to append.
+ * @param src_len The number of bytes to append.
+ * @return `ARENA_SUCCESS`, or `ARENA_ERROR_ALLOCATION_FAILED`/`ARENA_ERROR_REALLOCATION_FAILED`
+ *         if the string could not grow. On failure `dest` is unchanged.
+ */
+ArenaError string_append_bytes_malloc(String *dest, const char *src, size_t src_len);
+
 /**
  * @brief Appends another `String` to a malloc-allocated `String`.
  *
- * This function internally calls `string_append_char_array_malloc` to append the data 
- * from the source `String`.
+ * This function internally calls `string_append_bytes_malloc` with the stored length of the
+ * source `String`, so the source is not scanned again.
  *
  * @param dest The destination `String` to append to.
  * @param src The source `String` to append.
@@ -106,31 +461,1026 @@ void string_append_string_malloc(String *dest, const String *src);
 void string_append_string_arena(String *dest, const String *src, Arena *arena);
 
 /**
- * @brief  Calculates the length of a `String`.
- * 
- * This function determines the number of characters in the given `String`, 
- * excluding the null terminator.
+ * @brief Appends several null-terminated character arrays to a malloc-allocated `String`.
  *
- * @param string The `String` whose length you want to find.
- * 
- * @return The length of the `String` (the number of characters), or 0 if `string` is NULL.
+ * The total length is computed first, `dest` grows at most once and every part is copied exactly
+ * once. This is much cheaper than calling `string_append_char_array_malloc` for every part.
+ *
+ * @param dest The destination `String` to append to.
+ * @param parts The character arrays to append. They may point into `dest`.
+ * @param count The number of parts.
+ * @return `ARENA_SUCCESS`, or an error if the string could not grow or the total length does not fit in `size_t`.
+ *         On failure `dest` is unchanged.
+ */
+ArenaError string_concat_n_malloc(String *dest, const char *const *parts, size_t count);
+
+/**
+ * @brief Appends several views to a malloc-allocated `String`, growing it at most once.
+ *
+ * @see string_concat_n_malloc
+ */
+ArenaError string_concat_views_malloc(String *dest, const StringView *parts, size_t count);
+
+/**
+ * @brief Appends several `String`s to a malloc-allocated `String`, growing it at most once.
+ *
+ * The stored lengths of the parts are used, so none of them is scanned with `strlen`.
+ *
+ * @see string_concat_n_malloc
+ */
+ArenaError string_concat_strings_malloc(String *dest, const String *const *parts, size_t count);
+
+/**
+ * @brief Appends views separated by `separator` to a malloc-allocated `String`, growing it at most once.
+ *
+ * @param dest The destination `String` to append to.
+ * @param separator Inserted between two parts, not before the first or after the last one. It may point into `dest`.
+ * @param parts The views to append. They may point into `dest`.
+ * @param count The number of parts.
+ * @return `ARENA_SUCCESS`, or an error if the string could not grow or the total length does not fit in `size_t`.
+ *         On failure `dest` is unchanged.
  *
- * @note This function does not modify the `String` in any way.
- * 
  * @example
- * String* myString = new_string_malloc("Hello");
- * size_t length = string_length(myString); // length will be 5
- * 
+ * StringView parts[] = { string_view_from_cstr("usr"), string_view_from_cstr("local"), string_view_from_cstr("bin") };
+ * string_join_malloc(path, string_view_from_cstr("/"), parts, 3); // appends "usr/local/bin"
  */
-size_t string_length(String *string);
+ArenaError string_join_malloc(String *dest, StringView separator, const StringView *parts, size_t count);
 
 /**
- * @brief Frees the memory allocated for a `String` created with `new_string_malloc`.
+ * @brief Appends `String`s separated by `separator` to a malloc-allocated `String`, growing it at most once.
  *
- * This function first frees the internal string data (`string->data`) and then frees 
- * the `String` structure itself.
+ * @see string_join_malloc
+ */
+ArenaError string_join_strings_malloc(String *dest, StringView separator, const String *const *parts, size_t count);
+
+/**
+ * @brief Appends several null-terminated character arrays to an arena-allocated `String`, growing it at most once.
  *
- * @param string The `String` to free.
+ * @param arena A pointer to the `Arena` if `dest` is arena-allocated. If NULL, it is assumed that `dest` is malloc-allocated.
+ * @see string_concat_n_malloc
  */
-void string_free(String *string);
+ArenaError string_concat_n_arena(String *dest, const char *const *parts, size_t count, Arena *arena);
+
+/**
+ * @brief Appends several views to an arena-allocated `String`, growing it at most once.
+ *
+ * @see string_concat_n_arena
+ */
+ArenaError string_concat_views_arena(String *dest, const StringView *parts, size_t count, Arena *arena);
+
+/**
+ * @brief Appends several `String`s to an arena-allocated `String`, growing it at most once.
+ *
+ * @see string_concat_n_arena
+ */
+ArenaError string_concat_strings_arena(String *dest, const String *const *parts, size_t count, Arena *arena);
+
+/**
+ * @brief Appends views separated by `separator` to an arena-allocated `String`, growing it at most once.
+ *
+ * @see string_join_malloc
+ */
+ArenaError string_join_arena(String *dest, StringView separator, const StringView *parts, size_t count, Arena *arena);
+
+/**
+ * @brief Appends `String`s separated by `separator` to an arena-allocated `String`, growing it at most once.
+ *
+ * @see string_join_malloc
+ */
+ArenaError string_join_strings_arena(String *dest, StringView separator, const String *const *parts, size_t count, Arena *arena);
+
+/**
+ * @brief Inserts bytes into a malloc-allocated `String` at a given position.
+ *
+ * @param dest The `String` to insert into.
+ * @param pos The position to insert at. Positions past the end insert at the end.
+ * @param src The bytes to insert. They may point into `dest`.
+ * @param src_len The number of bytes to insert.
+ * @return `ARENA_SUCCESS`, or an error if the string could not grow. On failure `dest` is unchanged.
+ *
+ * @example
+ * String *path = new_string_malloc("/usr/bin");
+ * string_insert_malloc(path, 4, "/local", 6); // "/usr/local/bin"
+ */
+ArenaError string_insert_malloc(String *dest, size_t pos, const char *src, size_t src_len);
+
+/**
+ * @brief Inserts bytes into an arena-allocated `String` at a given position.
+ *
+ * @param arena A pointer to the `Arena` if `dest` is arena-allocated. If NULL, it is assumed that `dest` is malloc-allocated.
+ * @see string_insert_malloc
+ */
+ArenaError string_insert_arena(String *dest, size_t pos, const char *src, size_t src_len, Arena *arena);
+
+/**
+ * @brief Removes bytes from a `String`. Never allocates and works for every kind of `String`.
+ *
+ * @param string The `String` to modify.
+ * @param pos The first byte to remove. Positions past the end do nothing.
+ * @param length The number of bytes to remove. Clamped to the bytes available after `pos`.
+ */
+void string_erase(String *string, size_t pos, size_t length);
+
+/**
+ * @brief Replaces a range of a malloc-allocated `String` with other bytes.
+ *
+ * The tail of the string is moved exactly once, the string grows at most once.
+ *
+ * @param dest The `String` to modify.
+ * @param pos The first byte to replace. Clamped to the length of `dest`.
+ * @param length The number of bytes to replace. Clamped to the bytes available after `pos`.
+ * @param src The replacement bytes. They may point into `dest`.
+ * @param src_len The number of replacement bytes.
+ * @return `ARENA_SUCCESS`, or an error if the string could not grow. On failure `dest` is unchanged.
+ */
+ArenaError string_replace_range_malloc(String *dest, size_t pos, size_t length, const char *src, size_t src_len);
+
+/**
+ * @brief Replaces a range of an arena-allocated `String` with other bytes.
+ *
+ * @param arena A pointer to the `Arena` if `dest` is arena-allocated. If NULL, it is assumed that `dest` is malloc-allocated.
+ * @see string_replace_range_malloc
+ */
+ArenaError string_replace_range_arena(String *dest, size_t pos, size_t length, const char *src, size_t src_len, Arena *arena);
+
+/**
+ * @brief Replaces every non-overlapping occurrence of `needle` in a malloc-allocated `String`.
+ *
+ * Matches are found left to right like `string_view_find`. They are counted first, so `dest`
+ * grows at most once, and the string is then rewritten in a single pass in place.
+ *
+ * @param dest The `String` to modify.
+ * @param needle The text to replace. An empty needle does nothing.
+ * @param replacement The text to insert instead. Both views may point into `dest`.
+ * @return `ARENA_SUCCESS`, or an error if the string could not grow. On failure `dest` is unchanged.
+ *
+ * @example
+ * String *csv = new_string_malloc("a;b;c");
+ * string_replace_all_malloc(csv, string_view_from_cstr(";"), string_view_from_cstr(", ")); // "a, b, c"
+ */
+ArenaError string_replace_all_malloc(String *dest, StringView needle, StringView replacement);
+
+/**
+ * @brief Replaces every non-overlapping occurrence of `needle` in an arena-allocated `String`.
+ *
+ * @param arena A pointer to the `Arena` if `dest` is arena-allocated. If NULL, it is assumed that `dest` is malloc-allocated.
+ * @see string_replace_all_malloc
+ */
+ArenaError string_replace_all_arena(String *dest, StringView needle, StringView replacement, Arena *arena);
+
+/**
+ * @brief Appends `printf` style formatted output to a malloc-allocated `String`.
+ *
+ * The output is written with `vsnprintf` directly into the spare capacity of `dest`. Only if it
+ * does not fit, the string grows once to the exact required size and the output is formatted again.
+ * As with `vsnprintf` itself, the arguments must not point into `dest` (e.g. `%s` with `dest->data`).
+ *
+ * @param dest The destination `String` to append to.
+ * @param format The `printf` format string. Its arguments must not point into `dest`.
+ * @return The number of bytes appended, or -1 if formatting failed or the string could not grow.
+ *         On failure the content of `dest` is unchanged.
+ *
+ * @example
+ * String *line = new_string_malloc("level=");
+ * string_appendf_malloc(line, "%s code=%d", "warn", 404); // "level=warn code=404"
+ */
+int string_appendf_malloc(String *dest, const char *format, ...);
+
+/**
+ * @brief `va_list` version of `string_appendf_malloc`.
+ */
+int string_vappendf_malloc(String *dest, const char *format, va_list args);
+
+/**
+ * @brief Appends `printf` style formatted output to an arena-allocated `String`.
+ *
+ * @param dest The destination `String` to append to.
+ * @param arena A pointer to the `Arena` if `dest` is arena-allocated. If NULL, it is assumed that `dest` is malloc-allocated.
+ * @param format The `printf` format string. Its arguments must not point into `dest`.
+ * @return The number of bytes appended, or -1 if formatting failed or the string could not grow.
+ *         On failure the content of `dest` is unchanged.
+ */
+int string_appendf_arena(String *dest, Arena *arena, const char *format, ...);
+
+/**
+ * @brief `va_list` version of `string_appendf_arena`.
+ */
+int string_vappendf_arena(String *dest, Arena *arena, const char *format, va_list args);
+
+/**
+ * @brief Appends the decimal representation of a signed integer to an arena-allocated `String`.
+ *
+ * The digits are written directly into the buffer after a single capacity check, no `printf` is involved.
+ *
+ * @param dest The destination `String` to append to.
+ * @param value The value to append.
+ * @param arena A pointer to the `Arena` if `dest` is arena-allocated. If NULL, it is assumed that `dest` is malloc-allocated.
+ * @return `ARENA_SUCCESS`, or an error if the string could not grow. On failure `dest` is unchanged.
+ */
+ArenaError string_append_i64_arena(String *dest, int64_t value, Arena *arena);
+
+/**
+ * @brief Appends the decimal representation of an unsigned integer to an arena-allocated `String`.
+ *
+ * @see string_append_i64_arena
+ */
+ArenaError string_append_u64_arena(String *dest, uint64_t value, Arena *arena);
+
+/**
+ * @brief Appends the lowercase hexadecimal representation of an integer (without "0x" prefix or
+ *        leading zeros) to an arena-allocated `String`.
+ *
+ * @see string_append_i64_arena
+ */
+ArenaError string_append_hex_arena(String *dest, uint64_t value, Arena *arena);
+
+/**
+ * @brief Appends a `double` to an arena-allocated `String`.
+ *
+ * The digits are produced with the Grisu2 algorithm: the output parses back (e.g. with `strtod`)
+ * to exactly the same value and is the shortest such representation in virtually all cases.
+ * Numbers are laid out like JavaScript does: "0.001", "12.5", "1e+21", "1.5e-7". Integral values
+ * have no fractional part, special values are written as "nan", "inf" and "-inf".
+ *
+ * @see string_append_i64_arena
+ */
+ArenaError string_append_double_arena(String *dest, double value, Arena *arena);
+
+/**
+ * @brief Appends the decimal representation of a signed integer to a malloc-allocated `String`.
+ *
+ * @see string_append_i64_arena
+ */
+ArenaError string_append_i64_malloc(String *dest, int64_t value);
+
+/**
+ * @brief Appends the decimal representation of an unsigned integer to a malloc-allocated `String`.
+ *
+ * @see string_append_u64_arena
+ */
+ArenaError string_append_u64_malloc(String *dest, uint64_t value);
+
+/**
+ * @brief Appends the lowercase hexadecimal representation of an integer to a malloc-allocated `String`.
+ *
+ * @see string_append_hex_arena
+ */
+ArenaError string_append_hex_malloc(String *dest, uint64_t value);
+
+/**
+ * @brief Appends the shortest round-trip representation of a `double` to a malloc-allocated `String`.
+ *
+ * @see string_append_double_arena
+ */
+ArenaError string_append_double_malloc(String *dest, double value);
+
+/**
+ * @brief Parses a signed decimal integer at the start of a view.
+ *
+ * Accepts an optional '+' or '-' followed by decimal digits. Whitespace is not skipped and
+ * parsing stops at the first byte that is not a digit, so the view does not need to be null
+ * terminated. Digits are converted 8 at a time. The result does not depend on the locale.
+ *
+ * @param view The view to parse.
+ * @param value Receives the parsed value. On overflow it is set to `INT64_MIN` or `INT64_MAX`.
+ * @return The number of bytes consumed and the status.
+ */
+StringParseResult string_view_parse_i64(StringView view, int64_t *value);
+
+/**
+ * @brief Parses an unsigned decimal integer (with an optional '+') at the start of a view.
+ *
+ * @param view The view to parse.
+ * @param value Receives the parsed value. On overflow it is set to `UINT64_MAX`.
+ * @return The number of bytes consumed and the status.
+ *
+ * @see string_view_parse_i64
+ */
+StringParseResult string_view_parse_u64(StringView view, uint64_t *value);
+
+/**
+ * @brief Parses a floating-point number at the start of a view.
+ *
+ * Accepts an optional sign, digits with an optional '.' fraction and an optional exponent
+ * ('e' or 'E', optional sign, digits), as well as "inf", "infinity" and "nan" in any case.
+ * The decimal point is always '.', regardless of the locale. The result is correctly rounded,
+ * also for inputs with many digits, without calling into the C library or allocating.
+ *
+ * @param view The view to parse.
+ * @param value Receives the parsed value. On overflow it is set to plus or minus `HUGE_VAL`.
+ * @return The number of bytes consumed and the status.
+ */
+StringParseResult string_view_parse_double(StringView view, double *value);
+
+/**
+ * @brief Parses a signed integer at the start of a `String`, see `string_view_parse_i64`.
+ */
+StringParseResult string_parse_i64(const String *string, int64_t *value);
+
+/**
+ * @brief Parses an unsigned integer at the start of a `String`, see `string_view_parse_u64`.
+ */
+StringParseResult string_parse_u64(const String *string, uint64_t *value);
+
+/**
+ * @brief Parses a floating-point number at the start of a `String`, see `string_view_parse_double`.
+ */
+StringParseResult string_parse_double(const String *string, double *value);
+
+/**
+ * @brief  Calculates the length of a `String`.
+ * 
+ * This function determines the number of characters in the given `String`, 
+ * excluding the null terminator.
+ *
+ * @param string The `String` whose length you want to find.
+ * 
+ * @return The length of the `String` (the number of characters), or 0 if `string` is NULL.
+ *
+ * @note This function does not modify the `String` in any way.
+ * 
+ * @example
+ * String* myString = new_string_malloc("Hello");
+ * size_t length = string_length(myString); // length will be 5
+ * 
+ */
+size_t string_length(String *string);
+
+/**
+ * @brief Frees the memory allocated for a `String` created with `new_string_malloc` or `new_string_block`.
+ *
+ * This function first frees the internal string data (`string->data`), unless it is stored
+ * inline, and then frees the `String` structure itself.
+ *
+ * @param string The `String` to free.
+ */
+void string_free(String *string);
+
+/**
+ * @brief Creates a view of the whole content of a `String`.
+ *
+ * @param string The `String` to view.
+ * @return A view of `string->length` bytes starting at `string->data`.
+ */
+StringView string_view_from_string(const String *string);
+
+/**
+ * @brief Creates a view of a null-terminated character array.
+ *
+ * @param str The character array to view. Can be NULL, which results in an empty view.
+ * @return A view of `strlen(str)` bytes.
+ */
+StringView string_view_from_cstr(const char *str);
+
+/**
+ * @brief Creates a view of `len` bytes starting at `ptr`.
+ */
+StringView string_view_from_bytes(const char *ptr, size_t len);
+
+/**
+ * @brief Creates a view of a part of a `String` without copying it.
+ *
+ * @param string The `String` to view.
+ * @param start The index of the first byte of the slice. Clamped to the length of the string.
+ * @param length The number of bytes in the slice. Clamped to the bytes available after `start`.
+ * @return The view of the slice.
+ */
+StringView string_slice(const String *string, size_t start, size_t length);
+
+/**
+ * @brief Creates a view of a part of another view.
+ *
+ * @param view The view to slice.
+ * @param start The index of the first byte of the slice. Clamped to the length of the view.
+ * @param length The number of bytes in the slice. Clamped to the bytes available after `start`.
+ *               Pass `STRING_NPOS` to slice until the end.
+ * @return The view of the slice.
+ */
+StringView string_view_slice(StringView view, size_t start, size_t length);
+
+/**
+ * @brief Removes leading and trailing ASCII whitespace (space, \t, \n, \v, \f, \r) from a view.
+ */
+StringView string_view_trim(StringView view);
+
+/**
+ * @brief Removes leading ASCII whitespace from a view.
+ */
+StringView string_view_trim_left(StringView view);
+
+/**
+ * @brief Removes trailing ASCII whitespace from a view.
+ */
+StringView string_view_trim_right(StringView view);
+
+/**
+ * @brief Removes leading and trailing bytes that occur in `set` from a view.
+ *
+ * Long runs are skipped with the vectorized set search, sets of up to 8 bytes are fastest.
+ *
+ * @param view The view to strip.
+ * @param set The bytes to remove, e.g. `string_view_from_cstr(" \t,")`.
+ * @return The stripped view, pointing into the same bytes.
+ */
+StringView string_view_strip(StringView view, StringView set);
+
+/**
+ * @brief Removes leading bytes that occur in `set` from a view.
+ */
+StringView string_view_strip_left(StringView view, StringView set);
+
+/**
+ * @brief Removes trailing bytes that occur in `set` from a view.
+ */
+StringView string_view_strip_right(StringView view, StringView set);
+
+/**
+ * @brief Removes leading and trailing ASCII whitespace from a `String` in place.
+ *
+ * Never allocates. Trailing bytes are dropped by shortening the string, leading bytes by moving
+ * the rest to the front. Works for every kind of `String`.
+ *
+ * @example
+ * String *line = new_string_malloc("  key = value \n");
+ * string_trim(line); // "key = value"
+ */
+void string_trim(String *string);
+
+/**
+ * @brief Removes leading ASCII whitespace from a `String` in place.
+ */
+void string_trim_left(String *string);
+
+/**
+ * @brief Removes trailing ASCII whitespace from a `String` in place.
+ */
+void string_trim_right(String *string);
+
+/**
+ * @brief Removes leading and trailing bytes that occur in `set` from a `String` in place.
+ *
+ * @see string_trim
+ */
+void string_strip(String *string, StringView set);
+
+/**
+ * @brief Removes leading bytes that occur in `set` from a `String` in place.
+ */
+void string_strip_left(String *string, StringView set);
+
+/**
+ * @brief Removes trailing bytes that occur in `set` from a `String` in place.
+ */
+void string_strip_right(String *string, StringView set);
+
+/**
+ * @brief Replaces every run of bytes from `set` in a `String` by the first byte of the run, in place.
+ *
+ * @param string The `String` to modify.
+ * @param set The bytes whose runs are collapsed. It must not point into `string`.
+ *
+ * @example
+ * String *text = new_string_malloc("a  \t b");
+ * string_squeeze(text, string_view_from_cstr(" \t")); // "a b"
+ */
+void string_squeeze(String *string, StringView set);
+
+/**
+ * @brief Checks whether a view starts with `prefix`.
+ */
+bool string_view_starts_with(StringView view, StringView prefix);
+
+/**
+ * @brief Checks whether a view ends with `suffix`.
+ */
+bool string_view_ends_with(StringView view, StringView suffix);
+
+/**
+ * @brief Checks whether two views contain the same bytes.
+ *
+ * Views of different length are never equal, so this returns without looking at the bytes.
+ */
+bool string_view_equals(StringView a, StringView b);
+
+/**
+ * @brief Compares two views byte by byte (as unsigned char).
+ *
+ * @return A negative value if `a` sorts before `b`, 0 if both are equal and a positive value
+ *         otherwise. A view that is a prefix of another sorts first.
+ */
+int string_view_compare(StringView a, StringView b);
+
+/**
+ * @brief Computes a 64-bit hash of the bytes of a view.
+ *
+ * Uses a wyhash style function that processes 48 byte blocks in three independent lanes, so long
+ * inputs are hashed at several bytes per cycle. Equal contents always hash to the same value
+ * within a process, and the result is never 0. The hash is not meant to resist hash flooding.
+ *
+ * @param view The bytes to hash.
+ * @return The hash of the bytes.
+ */
+uint64_t string_view_hash(StringView view);
+
+/**
+ * @brief Computes the hash of a `String` and caches it in the string.
+ *
+ * Repeated calls return the cached value until the string is modified through this library,
+ * every appending or editing function resets the cache. Equal to `string_view_hash` of the
+ * string's content, so Strings and views can be looked up in the same table.
+ *
+ * @param string The `String` to hash.
+ * @return The hash of the content.
+ * @note After writing to `string->data` directly, call `string_invalidate_hash`.
+ */
+uint64_t string_hash(String *string);
+
+/**
+ * @brief Drops the cached hash of a `String`, needed after modifying `data` directly.
+ */
+void string_invalidate_hash(String *string);
+
+/**
+ * @brief Checks whether two `String`s have the same content.
+ *
+ * Strings of different length, or whose cached hashes (see `string_hash`) differ, are rejected
+ * without looking at the bytes. Embedded null bytes are compared like any other byte.
+ *
+ * @example
+ * if (string_equals(key, other)) { ... } // Instead of strcmp(key->data, other->data) == 0
+ */
+bool string_equals(const String *a, const String *b);
+
+/**
+ * @brief Compares two `String`s byte-wise like `memcmp`, a string that is a prefix of the other sorts first.
+ *
+ * @return A negative value, 0 or a positive value if `a` sorts before, equal to or after `b`.
+ */
+int string_compare(const String *a, const String *b);
+
+/**
+ * @brief Checks whether the content of a `String` starts with `prefix`.
+ */
+bool string_starts_with(const String *string, StringView prefix);
+
+/**
+ * @brief Checks whether the content of a `String` ends with `suffix`.
+ */
+bool string_ends_with(const String *string, StringView suffix);
+
+/**
+ * @brief Checks whether two views are equal when ASCII letters are compared case-insensitively.
+ *
+ * Only A-Z and a-z are folded, all other bytes must match exactly. 16 bytes are folded and
+ * compared at a time with SSE2.
+ */
+bool string_view_equals_ignore_case(StringView a, StringView b);
+
+/**
+ * @brief Compares two views with ASCII letters folded to lower case, like `strcasecmp` in the C locale.
+ *
+ * @return A negative value, 0 or a positive value if `a` sorts before, equal to or after `b`.
+ */
+int string_view_compare_ignore_case(StringView a, StringView b);
+
+/**
+ * @brief Checks whether a view starts with `prefix`, comparing ASCII letters case-insensitively.
+ */
+bool string_view_starts_with_ignore_case(StringView view, StringView prefix);
+
+/**
+ * @brief Checks whether a view ends with `suffix`, comparing ASCII letters case-insensitively.
+ */
+bool string_view_ends_with_ignore_case(StringView view, StringView suffix);
+
+/**
+ * @brief Checks whether two `String`s are equal when ASCII letters are compared case-insensitively.
+ *
+ * @see string_view_equals_ignore_case
+ */
+bool string_equals_ignore_case(const String *a, const String *b);
+
+/**
+ * @brief Compares two `String`s with ASCII letters folded to lower case.
+ *
+ * @see string_view_compare_ignore_case
+ */
+int string_compare_ignore_case(const String *a, const String *b);
+
+/**
+ * @brief Converts the ASCII letters of a `String` to lower case in place.
+ *
+ * Bytes other than A-Z are left unchanged, so UTF-8 text stays valid. Works on `length` bytes,
+ * 16 or 32 at a time, and never allocates.
+ *
+ * @example
+ * String *header = new_string_malloc("Content-Type");
+ * string_to_lower_ascii(header); // "content-type"
+ */
+void string_to_lower_ascii(String *string);
+
+/**
+ * @brief Converts the ASCII letters of a `String` to upper case in place.
+ *
+ * @see string_to_lower_ascii
+ */
+void string_to_upper_ascii(String *string);
+
+/**
+ * @brief Replaces every byte `b` of a `String` with `table[b]`, in place.
+ *
+ * @param string The `String` to transform.
+ * @param table The replacement of every byte value. Mapping bytes to 0 embeds null bytes.
+ */
+void string_transform_bytes(String *string, const unsigned char table[256]);
+
+/**
+ * @brief Replaces the content of a malloc-allocated `String` with `src` converted to ASCII lower case.
+ *
+ * `dest` only grows if its capacity is too small, so reusing one destination for many
+ * conversions does not allocate.
+ *
+ * @param dest The `String` receiving the result.
+ * @param src The text to convert. It may point into `dest`.
+ * @return `ARENA_SUCCESS`, or an error if the string could not grow. On failure `dest` is unchanged.
+ */
+ArenaError string_copy_lower_ascii_malloc(String *dest, StringView src);
+
+/**
+ * @brief Replaces the content of an arena-allocated `String` with `src` converted to ASCII lower case.
+ *
+ * @param arena A pointer to the `Arena` if `dest` is arena-allocated. If NULL, it is assumed that `dest` is malloc-allocated.
+ * @see string_copy_lower_ascii_malloc
+ */
+ArenaError string_copy_lower_ascii_arena(String *dest, StringView src, Arena *arena);
+
+/**
+ * @brief Replaces the content of a malloc-allocated `String` with `src` converted to ASCII upper case.
+ *
+ * @see string_copy_lower_ascii_malloc
+ */
+ArenaError string_copy_upper_ascii_malloc(String *dest, StringView src);
+
+/**
+ * @brief Replaces the content of an arena-allocated `String` with `src` converted to ASCII upper case.
+ *
+ * @param arena A pointer to the `Arena` if `dest` is arena-allocated. If NULL, it is assumed that `dest` is malloc-allocated.
+ * @see string_copy_lower_ascii_malloc
+ */
+ArenaError string_copy_upper_ascii_arena(String *dest, StringView src, Arena *arena);
+
+/**
+ * @brief Replaces the content of a malloc-allocated `String` with `src` mapped through `table`.
+ *
+ * @see string_transform_bytes
+ * @see string_copy_lower_ascii_malloc
+ */
+ArenaError string_copy_transform_bytes_malloc(String *dest, StringView src, const unsigned char table[256]);
+
+/**
+ * @brief Replaces the content of an arena-allocated `String` with `src` mapped through `table`.
+ *
+ * @param arena A pointer to the `Arena` if `dest` is arena-allocated. If NULL, it is assumed that `dest` is malloc-allocated.
+ * @see string_copy_transform_bytes_malloc
+ */
+ArenaError string_copy_transform_bytes_arena(String *dest, StringView src, const unsigned char table[256], Arena *arena);
+
+/**
+ * @brief Finds the first occurrence of a byte in a view.
+ *
+ * @param view The view to search.
+ * @param c The byte to look for.
+ * @param start The index to start searching at.
+ * @return The index of the byte, or `STRING_NPOS` if it does not occur at or after `start`.
+ */
+size_t string_view_find_char(StringView view, char c, size_t start);
+
+/**
+ * @brief Finds the last occurrence of a byte in a view.
+ *
+ * @param view The view to search.
+ * @param c The byte to look for.
+ * @param start The index to search backwards from. Pass `STRING_NPOS` to search the whole view.
+ * @return The index of the byte, or `STRING_NPOS` if it does not occur at or before `start`.
+ */
+size_t string_view_rfind_char(StringView view, char c, size_t start);
+
+/**
+ * @brief Finds the first occurrence of `needle` in a view.
+ *
+ * Uses SSE2, or AVX2 when the CPU supports it, to test 16 or 32 candidate positions at once.
+ *
+ * @param view The view to search.
+ * @param needle The bytes to look for. An empty needle matches at `start`.
+ * @param start The index to start searching at.
+ * @return The index of the match, or `STRING_NPOS` if `needle` does not occur at or after `start`.
+ */
+size_t string_view_find(StringView view, StringView needle, size_t start);
+
+/**
+ * @brief Finds the last occurrence of `needle` in a view.
+ *
+ * @param view The view to search.
+ * @param needle The bytes to look for.
+ * @param start The latest index a match may start at. Pass `STRING_NPOS` to search the whole view.
+ * @return The index of the match, or `STRING_NPOS` if `needle` does not occur at or before `start`.
+ */
+size_t string_view_rfind(StringView view, StringView needle, size_t start);
+
+/**
+ * @brief Finds the first byte at or after `start` that is one of the bytes in `set`.
+ *
+ * Sets of up to 8 bytes are matched 16 bytes at a time with SSE2.
+ *
+ * @return The index of the byte, or `STRING_NPOS` if there is none.
+ */
+size_t string_view_find_first_of(StringView view, StringView set, size_t start);
+
+/**
+ * @brief Finds the first byte at or after `start` that is not one of the bytes in `set`.
+ *
+ * @return The index of the byte, or `STRING_NPOS` if there is none.
+ */
+size_t string_view_find_first_not_of(StringView view, StringView set, size_t start);
+
+/**
+ * @brief Finds the last byte at or before `start` that is one of the bytes in `set`.
+ *
+ * @return The index of the byte, or `STRING_NPOS` if there is none.
+ */
+size_t string_view_find_last_of(StringView view, StringView set, size_t start);
+
+/**
+ * @brief Finds the last byte at or before `start` that is not one of the bytes in `set`.
+ *
+ * @return The index of the byte, or `STRING_NPOS` if there is none.
+ */
+size_t string_view_find_last_not_of(StringView view, StringView set, size_t start);
+
+/**
+ * @brief Finds the first occurrence of `needle` in a `String`, see `string_view_find`.
+ */
+size_t string_find(const String *string, StringView needle, size_t start);
+
+/**
+ * @brief Finds the last occurrence of `needle` in a `String`, see `string_view_rfind`.
+ */
+size_t string_rfind(const String *string, StringView needle, size_t start);
+
+/**
+ * @brief Finds the first occurrence of a byte in a `String`, see `string_view_find_char`.
+ */
+size_t string_find_char(const String *string, char c, size_t start);
+
+/**
+ * @brief Finds the last occurrence of a byte in a `String`, see `string_view_rfind_char`.
+ */
+size_t string_rfind_char(const String *string, char c, size_t start);
+
+/**
+ * @brief Finds the first byte of a `String` that is in `set`, see `string_view_find_first_of`.
+ */
+size_t string_find_first_of(const String *string, StringView set, size_t start);
+
+/**
+ * @brief Finds the first byte of a `String` that is not in `set`, see `string_view_find_first_not_of`.
+ */
+size_t string_find_first_not_of(const String *string, StringView set, size_t start);
+
+/**
+ * @brief Finds the last byte of a `String` that is in `set`, see `string_view_find_last_of`.
+ */
+size_t string_find_last_of(const String *string, StringView set, size_t start);
+
+/**
+ * @brief Finds the last byte of a `String` that is not in `set`, see `string_view_find_last_not_of`.
+ */
+size_t string_find_last_not_of(const String *string, StringView set, size_t start);
+
+/**
+ * @brief Splits a view at every occurrence of a delimiter byte.
+ *
+ * Splitting "a,,b" at ',' yields "a", "" and "b". An input without delimiters (including an
+ * empty input) yields exactly one token.
+ *
+ * @param input The view to split. Use `string_view_from_string` to split a `String`.
+ * @param delimiter The delimiter byte.
+ * @return An iterator to pass to `string_split_next`.
+ */
+StringSplitIterator string_split_char(StringView input, char delimiter);
+
+/**
+ * @brief Splits a view at every byte that is contained in `delimiters`.
+ *
+ * @param input The view to split.
+ * @param delimiters The set of delimiter bytes. The bytes must stay valid while iterating.
+ * @return An iterator to pass to `string_split_next`.
+ */
+StringSplitIterator string_split_any(StringView input, StringView delimiters);
+
+/**
+ * @brief Splits a view at every (non-overlapping) occurrence of `delimiter`.
+ *
+ * @param input The view to split.
+ * @param delimiter The delimiter. The bytes must stay valid while iterating. An empty delimiter
+ *                  yields the whole input as a single token.
+ * @return An iterator to pass to `string_split_next`.
+ */
+StringSplitIterator string_split_substring(StringView input, StringView delimiter);
+
+/**
+ * @brief Returns the next token of a split.
+ *
+ * Delimiters are located with the vectorized search functions.
+ *
+ * @param it The iterator.
+ * @param token Receives a view of the next token.
+ * @return `true` if a token was returned, `false` once all tokens have been returned.
+ *
+ * @example
+ * StringSplitIterator it = string_split_char(string_view_from_string(line), ',');
+ * StringView field;
+ * while (string_split_next(&it, &field)) {
+ *     // use field.ptr and field.len
+ * }
+ */
+bool string_split_next(StringSplitIterator *it, StringView *token);
+
+/**
+ * @brief Collects the positions of a delimiter byte in one pass (bulk split).
+ *
+ * The input is scanned 16 (SSE2) or 32 (AVX2) bytes at a time and the index of every delimiter
+ * is written to `offsets`. Token `i` then spans from `offsets[i - 1] + 1` to `offsets[i]`.
+ *
+ * @param input The view to scan.
+ * @param delimiter The delimiter byte.
+ * @param start The index to start scanning at.
+ * @param offsets Receives the indices of the delimiters in ascending order.
+ * @param max_offsets The capacity of `offsets`.
+ * @return The number of indices written. If it equals `max_offsets` there may be more delimiters,
+ *         continue with `start` set to `offsets[max_offsets - 1] + 1`.
+ */
+size_t string_split_offsets(StringView input, char delimiter, size_t start, size_t *offsets, size_t max_offsets);
+
+/**
+ * @brief Checks whether a view holds well-formed UTF-8.
+ *
+ * Rejects overlong encodings, surrogates, code points above U+10FFFF and truncated sequences.
+ * Blocks of ASCII are skipped 16 or 32 bytes at a time. On CPUs with AVX2 all other input is
+ * checked 32 bytes at a time with the lookup table algorithm by Keiser and Lemire, without
+ * decoding individual code points.
+ *
+ * @param view The bytes to check.
+ * @return `true` if the view is valid UTF-8.
+ */
+bool string_view_utf8_validate(StringView view);
+
+/**
+ * @brief Checks whether a `String` holds well-formed UTF-8.
+ *
+ * @see string_view_utf8_validate
+ */
+bool string_utf8_validate(const String *string);
+
+/**
+ * @brief Counts the code points of valid UTF-8 text.
+ *
+ * Counts every byte that is not a continuation byte, 16 bytes at a time. The result for
+ * invalid input is unspecified, validate untrusted input first.
+ *
+ * @param view Valid UTF-8 text.
+ * @return The number of code points.
+ */
+size_t string_view_utf8_length(StringView view);
+
+/**
+ * @brief Counts the code points of a `String` holding valid UTF-8.
+ *
+ * @see string_view_utf8_length
+ */
+size_t string_utf8_length(const String *string);
+
+/**
+ * @brief Starts decoding the code points of UTF-8 text.
+ *
+ * @example
+ * StringUtf8Iterator it = string_utf8_iterate(string_view_from_string(text));
+ * uint32_t code_point;
+ * while (string_utf8_next(&it, &code_point)) {
+ *     ...
+ * }
+ */
+StringUtf8Iterator string_utf8_iterate(StringView view);
+
+/**
+ * @brief Decodes the next code point.
+ *
+ * An invalid sequence yields `STRING_UTF8_REPLACEMENT` once for its longest valid prefix (at
+ * least one byte), as recommended by the Unicode standard, and decoding continues after it.
+ *
+ * @param it The iterator.
+ * @param code_point Receives the decoded code point.
+ * @return `true` if a code point was decoded, `false` at the end of the text.
+ */
+bool string_utf8_next(StringUtf8Iterator *it, uint32_t *code_point);
+
+/**
+ * @brief Appends Latin-1 (ISO-8859-1) text to a malloc-allocated `String`, converting it to UTF-8.
+ *
+ * The size of the output is computed first, so `dest` grows at most once. Runs of ASCII are
+ * copied 16 bytes at a time. Every byte is one character, so input split across several
+ * buffers can simply be appended buffer by buffer.
+ *
+ * @param dest The `String` to append to.
+ * @param src The Latin-1 bytes. They may point into `dest`.
+ * @param len The number of bytes.
+ * @return `ARENA_SUCCESS`, or an error if the string could not grow. On failure `dest` is unchanged.
+ */
+ArenaError string_append_latin1_malloc(String *dest, const char *src, size_t len);
+
+/**
+ * @brief Appends Latin-1 text to an arena-allocated `String`, converting it to UTF-8.
+ *
+ * @param arena A pointer to the `Arena` if `dest` is arena-allocated. If NULL, it is assumed that `dest` is malloc-allocated.
+ * @see string_append_latin1_malloc
+ */
+ArenaError string_append_latin1_arena(String *dest, const char *src, size_t len, Arena *arena);
+
+/**
+ * @brief Appends UTF-16 text to a malloc-allocated `String`, converting it to UTF-8.
+ *
+ * The code units are read in the byte order of the machine. Unpaired surrogates are replaced
+ * with U+FFFD. The size of the output is computed first, so `dest` grows at most once, and runs
+ * of ASCII are converted 8 code units at a time.
+ *
+ * @param dest The `String` to append to.
+ * @param src The UTF-16 code units. They may point into `dest`.
+ * @param len The number of code units.
+ * @return `ARENA_SUCCESS`, or an error if the string could not grow. On failure `dest` is unchanged.
+ *
+ * @example
+ * static const uint16_t greeting[] = { 0x0048, 0x0069, 0xD83D, 0xDC4B }; // "Hi" and a waving hand
+ * String *text = new_string_malloc("");
+ * string_append_utf16_malloc(text, greeting, 4);
+ */
+ArenaError string_append_utf16_malloc(String *dest, const uint16_t *src, size_t len);
+
+/**
+ * @brief Appends UTF-16 text to an arena-allocated `String`, converting it to UTF-8.
+ *
+ * @param arena A pointer to the `Arena` if `dest` is arena-allocated. If NULL, it is assumed that `dest` is malloc-allocated.
+ * @see string_append_utf16_malloc
+ */
+ArenaError string_append_utf16_arena(String *dest, const uint16_t *src, size_t len, Arena *arena);
+
+/**
+ * @brief Prepares a decoder for UTF-16 input that arrives in several buffers.
+ */
+void string_utf16_decoder_init(StringUtf16Decoder *decoder);
+
+/**
+ * @brief Converts the next buffer of a UTF-16 stream and appends it to a malloc-allocated `String`.
+ *
+ * A high surrogate at the end of `src` is kept in the decoder until the next call.
+ *
+ * @param decoder The decoder state.
+ * @param dest The `String` to append to.
+ * @param src The next code units of the stream. They may point into `dest`.
+ * @param len The number of code units.
+ * @return `ARENA_SUCCESS`, or an error if the string could not grow. On failure neither `dest`
+ *         nor the decoder are changed.
+ *
+ * @example
+ * StringUtf16Decoder decoder;
+ * string_utf16_decoder_init(&decoder);
+ * while ((units = read_units(socket, buffer, capacity)) > 0) {
+ *     string_utf16_decoder_append_malloc(&decoder, text, buffer, units);
+ * }
+ * string_utf16_decoder_finish_malloc(&decoder, text);
+ */
+ArenaError string_utf16_decoder_append_malloc(StringUtf16Decoder *decoder, String *dest, const uint16_t *src, size_t len);
+
+/**
+ * @brief Converts the next buffer of a UTF-16 stream and appends it to an arena-allocated `String`.
+ *
+ * @param arena A pointer to the `Arena` if `dest` is arena-allocated. If NULL, it is assumed that `dest` is malloc-allocated.
+ * @see string_utf16_decoder_append_malloc
+ */
+ArenaError string_utf16_decoder_append_arena(StringUtf16Decoder *decoder, String *dest, const uint16_t *src, size_t len, Arena *arena);
+
+/**
+ * @brief Ends a UTF-16 stream. A high surrogate left over from the last buffer becomes U+FFFD.
+ *
+ * @return `ARENA_SUCCESS`, or an error if the string could not grow.
+ */
+ArenaError string_utf16_decoder_finish_malloc(StringUtf16Decoder *decoder, String *dest);
+
+/**
+ * @brief Ends a UTF-16 stream written to an arena-allocated `String`.
+ *
+ * @param arena A pointer to the `Arena` if `dest` is arena-allocated. If NULL, it is assumed that `dest` is malloc-allocated.
+ * @see string_utf16_decoder_finish_malloc
+ */
+ArenaError string_utf16_decoder_finish_arena(StringUtf16Decoder *decoder, String *dest, Arena *arena);
+
 #endif // End of the conditional compilation block
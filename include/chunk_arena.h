@@ -0,0 +1,122 @@
+/**
+ * @file chunk_arena.h
+ * @brief Chunked arena allocator used as a string backend
+ *
+ * A `ChunkArena` hands out memory from a list of fixed-size blocks. When the current block is
+ * full a new block is added, and large allocations get a dedicated block of their own. Existing
+ * allocations never move, so pointers into the arena stay valid until it is reset or freed, and
+ * the cost of an allocation does not depend on how much the arena already holds.
+ *
+ */
+
+#ifndef CHUNK_ARENA_H
+#define CHUNK_ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Block size used when `chunk_arena_init` is called with a block size of 0.
+ */
+#define CHUNK_ARENA_DEFAULT_BLOCK_SIZE (64 * 1024)
+
+typedef struct ChunkArenaBlock
+{
+    struct ChunkArenaBlock *next; // Block that was created before this one
+    size_t size;                  // Usable bytes in data
+    size_t used;                  // Bytes of data handed out so far
+    unsigned char data[];         // Memory the allocations are bumped from
+} ChunkArenaBlock;
+
+typedef struct
+{
+    ChunkArenaBlock *head;    // Most recently created block, every block is reachable from here
+    ChunkArenaBlock *current; // Block small allocations are bumped from
+    size_t block_size;        // Size of regular blocks
+} ChunkArena;
+
+/**
+ * @brief A save point of a `ChunkArena`, created with `chunk_arena_mark`.
+ */
+typedef struct
+{
+    ChunkArenaBlock *head;    // Most recent block at the time of the mark
+    ChunkArenaBlock *current; // Current block at the time of the mark
+    size_t used;              // Bytes used in the current block at the time of the mark
+} ChunkArenaMark;
+
+/**
+ * @brief Initializes an empty `ChunkArena`.
+ *
+ * No memory is allocated until the first allocation.
+ *
+ * @param arena The arena to initialize.
+ * @param block_size Size of a regular block in bytes, 0 selects `CHUNK_ARENA_DEFAULT_BLOCK_SIZE`.
+ */
+void chunk_arena_init(ChunkArena *arena, size_t block_size);
+
+/**
+ * @brief Allocates `size` bytes with the given alignment from the arena.
+ *
+ * Allocations larger than a quarter of the block size get a dedicated block, so they neither
+ * waste the rest of the current block nor force a regular block to be abandoned.
+ *
+ * @param arena The arena to allocate from.
+ * @param size The number of bytes to allocate.
+ * @param alignment The required alignment, must be a power of two.
+ * @return A pointer to the memory, or NULL if a new block could not be allocated.
+ */
+void *chunk_arena_allocate(ChunkArena *arena, size_t size, size_t alignment);
+
+/**
+ * @brief Tries to grow the most recent allocation in place.
+ *
+ * This only succeeds if `ptr + old_size` is the current bump pointer and the current block has
+ * room for the additional bytes.
+ *
+ * @param arena The arena `ptr` was allocated from.
+ * @param ptr The start of the allocation to grow.
+ * @param old_size The current size of the allocation.
+ * @param new_size The requested size of the allocation.
+ * @return `true` if the allocation now spans `new_size` bytes, `false` if nothing changed.
+ */
+bool chunk_arena_try_extend(ChunkArena *arena, void *ptr, size_t old_size, size_t new_size);
+
+/**
+ * @brief Records the current state of the arena.
+ *
+ * @param arena The arena to mark.
+ * @return A save point that can be passed to `chunk_arena_restore`.
+ */
+ChunkArenaMark chunk_arena_mark(const ChunkArena *arena);
+
+/**
+ * @brief Rolls the arena back to a save point.
+ *
+ * Only memory allocated (or grown in place) after the mark is released, everything allocated
+ * before it stays valid. This lets a failed multi-step construction undo its own allocations
+ * without touching other data in the arena.
+ *
+ * @param arena The arena to roll back.
+ * @param mark A save point of this arena created with `chunk_arena_mark`. Marks taken after
+ *             `mark` become invalid.
+ */
+void chunk_arena_restore(ChunkArena *arena, ChunkArenaMark mark);
+
+/**
+ * @brief Releases every allocation made from the arena.
+ *
+ * All blocks except one regular block are freed, the remaining block is kept for reuse.
+ *
+ * @param arena The arena to reset.
+ */
+void chunk_arena_reset(ChunkArena *arena);
+
+/**
+ * @brief Frees all blocks of the arena.
+ *
+ * @param arena The arena to free. It can be used again after calling `chunk_arena_init`.
+ */
+void chunk_arena_free(ChunkArena *arena);
+
+#endif // CHUNK_ARENA_H
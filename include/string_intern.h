@@ -0,0 +1,108 @@
+/**
+ * @file string_intern.h
+ * @brief Thread-safe pool that stores one copy of every distinct string
+ *
+ * Interning maps equal contents to the same `String`, so identifiers such as field names or tag
+ * keys are stored once, and comparing two interned strings is a pointer or id comparison instead
+ * of a `memcmp`. Interned strings live in per-shard `ChunkArena`s and never move, the returned
+ * pointers and ids stay valid until the pool is freed.
+ *
+ * The pool is split into `STRING_INTERN_SHARDS` independent shards, each with its own lock,
+ * open-addressing index and arena. Threads that intern different strings rarely contend.
+ *
+ */
+
+#ifndef STRING_INTERN_H
+#define STRING_INTERN_H
+
+#include "c_string.h"
+#include <threads.h>
+
+/**
+ * @brief Number of independent shards of a pool, must be a power of two.
+ */
+#define STRING_INTERN_SHARDS 16
+
+/**
+ * @brief Id returned for strings that could not be interned.
+ */
+#define STRING_INTERN_INVALID_ID UINT32_MAX
+
+/**
+ * @brief Small integer identifying an interned string within its pool.
+ */
+typedef uint32_t StringInternId;
+
+typedef struct
+{
+    uint32_t hash;  // Low 32 bits of the hash of the string, checked before comparing bytes
+    uint32_t index; // Index into strings plus one, 0 marks an empty slot
+} StringInternSlot;
+
+typedef struct
+{
+    mtx_t lock;
+    StringInternSlot *slots; // Open-addressing index, power of two sized
+    size_t slot_count;       // Number of slots
+    const String **strings;  // Interned strings in insertion order
+    size_t count;            // Number of interned strings
+    size_t capacity;         // Capacity of strings
+    ChunkArena arena;        // Storage of the interned strings
+} StringInternShard;
+
+typedef struct
+{
+    StringInternShard shards[STRING_INTERN_SHARDS];
+} StringInternPool;
+
+/**
+ * @brief Initializes an empty intern pool.
+ *
+ * @param pool The pool to initialize.
+ * @return `ARENA_SUCCESS`, or `ARENA_ERROR_ALLOCATION_FAILED` if the shard locks could not be created.
+ */
+ArenaError string_intern_pool_init(StringInternPool *pool);
+
+/**
+ * @brief Frees the pool and every string interned in it.
+ */
+void string_intern_pool_free(StringInternPool *pool);
+
+/**
+ * @brief Returns the unique interned copy of `text`, adding it to the pool if needed.
+ *
+ * Can be called from several threads at the same time. Two calls with equal contents return the
+ * same pointer and id, so interned strings can be compared with `==`. The returned string must
+ * not be modified or freed.
+ *
+ * @param pool The pool to intern into.
+ * @param text The contents to intern. It may contain null bytes.
+ * @param id If not NULL, receives the id of the string, or `STRING_INTERN_INVALID_ID` on failure.
+ * @return The interned string, or NULL if allocation fails.
+ *
+ * @example
+ * const String *a = string_intern(&pool, string_view_from_cstr("user_id"), NULL);
+ * const String *b = string_intern(&pool, string_view_from_cstr("user_id"), NULL);
+ * // a == b
+ */
+const String *string_intern(StringInternPool *pool, StringView text, StringInternId *id);
+
+/**
+ * @brief Returns the interned copy of `text` if it is in the pool, without adding it.
+ *
+ * @param id If not NULL, receives the id of the string, or `STRING_INTERN_INVALID_ID` if it is not interned.
+ * @return The interned string, or NULL if `text` has not been interned.
+ */
+const String *string_intern_find(StringInternPool *pool, StringView text, StringInternId *id);
+
+/**
+ * @brief Returns the interned string with the given id, or NULL if the id is unknown.
+ */
+const String *string_intern_lookup(StringInternPool *pool, StringInternId id);
+
+/**
+ * @brief Returns the number of distinct strings in the pool.
+ */
+size_t string_intern_count(StringInternPool *pool);
+
+#endif // STRING_INTERN_H
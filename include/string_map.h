@@ -0,0 +1,148 @@
+/**
+ * @file string_map.h
+ * @brief Open-addressing hash map from string keys to pointer values
+ *
+ * `StringMap` is a Swiss-table style map: besides the entries it keeps one control byte per slot
+ * holding 7 bits of the key's hash, and lookups compare 16 control bytes at once with SSE2
+ * before touching any key. Keys are copied into an arena owned by the map, values are `void *`.
+ *
+ * Lookups take a `StringView`, so a `const char *` and a length, a `String` or a part of a larger
+ * buffer can be looked up without building a `String` first.
+ *
+ */
+
+#ifndef STRING_MAP_H
+#define STRING_MAP_H
+
+#include "c_string.h"
+
+typedef struct
+{
+    const String *key; // Copy of the key in the map's arena, its hash is cached
+    void *value;       // Value stored for the key
+} StringMapEntry;
+
+typedef struct
+{
+    StringMapEntry *entries; // One entry per slot
+    int8_t *control;         // One control byte per slot, followed by a copy of the first group
+    size_t capacity;         // Number of slots, a power of two and 0 for an empty map
+    size_t size;             // Number of keys in the map
+    size_t growth_left;      // Number of inserts into empty slots before the table has to grow
+    ChunkArena keys;         // Storage of the keys
+} StringMap;
+
+/**
+ * @brief Initializes an empty map. No memory is allocated until the first insert.
+ */
+void string_map_init(StringMap *map);
+
+/**
+ * @brief Frees the table and all keys of the map. Values are not touched.
+ */
+void string_map_free(StringMap *map);
+
+/**
+ * @brief Returns the number of keys in the map.
+ */
+size_t string_map_size(const StringMap *map);
+
+/**
+ * @brief Makes room for at least `count` keys, so that inserting them does not rehash.
+ *
+ * @return `ARENA_SUCCESS`, or `ARENA_ERROR_ALLOCATION_FAILED`. On failure the map is unchanged.
+ */
+ArenaError string_map_reserve(StringMap *map, size_t count);
+
+/**
+ * @brief Returns the value slot of `key`, inserting the key with a NULL value if it is missing.
+ *
+ * This is the fastest way to aggregate, the key is hashed and probed only once.
+ *
+ * @param map The map.
+ * @param key The key. It is copied into the map if it is inserted.
+ * @param inserted If not NULL, receives whether the key was newly inserted.
+ * @return A pointer to the value of the key, valid until the next insert. NULL if allocation fails.
+ *
+ * @example
+ * bool inserted;
+ * void **count = string_map_emplace(&counts, word, &inserted);
+ * *count = (void *)((uintptr_t)*count + 1);
+ */
+void **string_map_emplace(StringMap *map, StringView key, bool *inserted);
+
+/**
+ * @brief Like `string_map_emplace`, but reuses the cached hash of a `String` key.
+ */
+void **string_map_emplace_string(StringMap *map, String *key, bool *inserted);
+
+/**
+ * @brief Sets the value of `key`, inserting the key if needed.
+ *
+ * @return `ARENA_SUCCESS`, or `ARENA_ERROR_ALLOCATION_FAILED`.
+ */
+ArenaError string_map_upsert(StringMap *map, StringView key, void *value);
+
+/**
+ * @brief Inserts many keys at once. The table is sized once for all of them.
+ *
+ * Keys that are already present, or repeated within `keys`, keep their first value.
+ *
+ * @param map The map.
+ * @param keys The keys to insert.
+ * @param values The value of every key, or NULL to insert every key with a NULL value.
+ * @param count The number of keys.
+ * @return `ARENA_SUCCESS`, or `ARENA_ERROR_ALLOCATION_FAILED`. On failure some keys may have been inserted.
+ */
+ArenaError string_map_insert_bulk(StringMap *map, const StringView *keys, void *const *values, size_t count);
+
+/**
+ * @brief Returns the value slot of `key`, or NULL if the key is not in the map.
+ *
+ * @return A pointer to the value of the key, valid until the next insert.
+ */
+void **string_map_find(const StringMap *map, StringView key);
+
+/**
+ * @brief Like `string_map_find`, but reuses the cached hash of a `String` key.
+ */
+void **string_map_find_string(const StringMap *map, String *key);
+
+/**
+ * @brief Looks up a key given as pointer and length, without building a `String` or view first.
+ */
+void **string_map_find_bytes(const StringMap *map, const char *key, size_t key_len);
+
+/**
+ * @brief Returns the value of `key`, or NULL if the key is not in the map.
+ */
+void *string_map_get(const StringMap *map, StringView key);
+
+/**
+ * @brief Removes `key` from the map.
+ *
+ * The slot is marked as deleted and reused by later inserts. The memory of the key is released
+ * when the map is freed.
+ *
+ * @param value If not NULL, receives the value the key had.
+ * @return `true` if the key was in the map.
+ */
+bool string_map_remove(StringMap *map, StringView key, void **value);
+
+/**
+ * @brief Iterates over the entries of the map in no particular order.
+ *
+ * @param map The map.
+ * @param cursor Position of the iteration, set it to 0 before the first call.
+ * @return The next entry, or NULL once all entries have been visited.
+ *
+ * @example
+ * size_t cursor = 0;
+ * const StringMapEntry *entry;
+ * while ((entry = string_map_next(&map, &cursor))) {
+ *     printf("%s\n", entry->key->data);
+ * }
+ */
+const StringMapEntry *string_map_next(const StringMap *map, size_t *cursor);
+
+#endif // STRING_MAP_H
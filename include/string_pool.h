@@ -0,0 +1,68 @@
+/**
+ * @file string_pool.h
+ * @brief Thread-local pools of recycled Strings and data buffers
+ *
+ * Services that create and free many short-lived strings on many threads spend a lot of time
+ * in `malloc` and `free`, which contend on the allocator's locks. Strings created with
+ * `string_builder_acquire` instead take their header and data buffer from a cache owned by the
+ * calling thread. Buffers come in power of two size classes from 64 bytes to
+ * `STRING_POOL_MAX_BUFFER`. Released buffers go back to the cache of the thread that created
+ * them; buffers released on another thread are handed back through a lock-free stack. Once the
+ * caches are warm, acquiring, growing and releasing strings does not call the system allocator.
+ *
+ * Each thread caches at most `STRING_POOL_CACHE_BYTES` of buffers over all size classes,
+ * anything beyond is freed. Buffers released on other threads wait for their owner on a stack
+ * bounded by the same amount and are collected when the owner misses its cache or releases a
+ * buffer. A thread's caches are freed when the thread exits.
+ *
+ */
+
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include "c_string.h"
+
+/**
+ * @brief Largest data buffer taken from the pool, larger strings use `malloc`.
+ */
+#define STRING_POOL_MAX_BUFFER (64 * 1024)
+
+/**
+ * @brief Upper bound for the bytes a thread keeps cached, and for the bytes other threads return to it.
+ */
+#define STRING_POOL_CACHE_BYTES (256 * 1024)
+
+/**
+ * @brief Creates an empty `String` whose header and data come from the calling thread's pool.
+ *
+ * The result is an ordinary malloc-style `String`: use the `_malloc` functions on it, it grows
+ * within the pool, and `string_builder_release` or `string_free` gives its memory back. It may
+ * be released on any thread.
+ *
+ * @param capacity Number of bytes to reserve, excluding the null terminator.
+ * @return The new `String`, or NULL if allocation fails.
+ *
+ * @example
+ * String *line = string_builder_acquire(128);
+ * string_appendf_malloc(line, "%s=%d", key, value);
+ * send_line(line);
+ * string_builder_release(line);
+ */
+String *string_builder_acquire(size_t capacity);
+
+/**
+ * @brief Gives a `String` from `string_builder_acquire` back to the pool. Same as `string_free`.
+ */
+void string_builder_release(String *builder);
+
+/**
+ * @brief Frees every buffer cached by the calling thread, including buffers other threads returned to it.
+ */
+void string_pool_trim(void);
+
+/**
+ * @brief Returns the number of bytes of data buffers cached by the calling thread.
+ */
+size_t string_pool_cached_bytes(void);
+
+#endif // STRING_POOL_H
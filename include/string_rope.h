@@ -0,0 +1,157 @@
+/**
+ * @file string_rope.h
+ * @brief Rope for very large strings with cheap edits in the middle
+ *
+ * A `Rope` stores text as a balanced (AVL) tree whose leaves hold chunks of at most
+ * `ROPE_LEAF_MAX` bytes. Inserting, erasing and taking substrings cost O(log n) instead of the
+ * O(n) memmove a flat `String` needs, which makes it a good fit for large generated documents
+ * that are edited in many places before being written out.
+ *
+ * Nodes and text are allocated from a `ChunkArena` and never modified after creation. Edits build
+ * new nodes and share everything else, so a substring or an older version of a rope stays valid
+ * while the rope is edited. Memory of replaced nodes is reclaimed when the arena is reset or freed.
+ *
+ */
+
+#ifndef STRING_ROPE_H
+#define STRING_ROPE_H
+
+#include "c_string.h"
+
+/**
+ * @brief Maximum number of bytes stored in a single leaf.
+ */
+#define ROPE_LEAF_MAX 512
+
+/**
+ * @brief Upper bound for the height of a rope, used to size iteration stacks.
+ */
+#define ROPE_MAX_HEIGHT 96
+
+typedef struct RopeNode
+{
+    struct RopeNode *left;  // Left subtree, NULL for leaves
+    struct RopeNode *right; // Right subtree, NULL for leaves
+    const char *bytes;      // Text of a leaf, NULL for inner nodes
+    size_t length;          // Number of bytes in this subtree
+    unsigned height;        // 0 for leaves
+} RopeNode;
+
+typedef struct
+{
+    RopeNode *root;    // NULL for an empty rope
+    ChunkArena *arena; // Arena nodes and text are allocated from
+} Rope;
+
+/**
+ * @brief Iterator over the chunks of a rope, see `rope_chunks_begin`.
+ */
+typedef struct
+{
+    const RopeNode *stack[ROPE_MAX_HEIGHT]; // Subtrees that still have to be visited
+    size_t depth;                           // Number of entries on the stack
+} RopeChunkIterator;
+
+/**
+ * @brief Initializes an empty rope.
+ *
+ * @param rope The rope to initialize.
+ * @param arena The arena that nodes and text of the rope are allocated from.
+ */
+void rope_init(Rope *rope, ChunkArena *arena);
+
+/**
+ * @brief Returns the number of bytes in the rope.
+ */
+size_t rope_length(const Rope *rope);
+
+/**
+ * @brief Returns the byte at `index`, or '\0' if the index is out of bounds. O(log n).
+ */
+char rope_char_at(const Rope *rope, size_t index);
+
+/**
+ * @brief Inserts `text` at position `pos`.
+ *
+ * @param rope The rope to modify.
+ * @param pos The position to insert at. Clamped to the length of the rope.
+ * @param text The bytes to insert, they are copied into the arena.
+ * @return `ARENA_SUCCESS`, or `ARENA_ERROR_ALLOCATION_FAILED`. On failure the rope is unchanged.
+ */
+ArenaError rope_insert(Rope *rope, size_t pos, StringView text);
+
+/**
+ * @brief Appends `text` to the end of the rope.
+ *
+ * @see rope_insert
+ */
+ArenaError rope_append(Rope *rope, StringView text);
+
+/**
+ * @brief Removes `length` bytes starting at `pos`.
+ *
+ * @param rope The rope to modify.
+ * @param pos The first byte to remove. Clamped to the length of the rope.
+ * @param length The number of bytes to remove. Clamped to the bytes available after `pos`.
+ * @return `ARENA_SUCCESS`, or `ARENA_ERROR_ALLOCATION_FAILED`. On failure the rope is unchanged.
+ */
+ArenaError rope_erase(Rope *rope, size_t pos, size_t length);
+
+/**
+ * @brief Creates a rope holding `length` bytes of `rope` starting at `pos`.
+ *
+ * The result shares nodes and text with `rope`, nothing is copied.
+ *
+ * @param rope The rope to take the substring of.
+ * @param pos The first byte of the substring. Clamped to the length of the rope.
+ * @param length The number of bytes. Clamped to the bytes available after `pos`.
+ * @param out Receives the substring. It uses the same arena as `rope`.
+ * @return `ARENA_SUCCESS`, or `ARENA_ERROR_ALLOCATION_FAILED`.
+ */
+ArenaError rope_substring(const Rope *rope, size_t pos, size_t length, Rope *out);
+
+/**
+ * @brief Starts iterating over the chunks of a rope in order.
+ *
+ * Chunks are views into the rope, so they can be handed to `fwrite` or `writev` without copying.
+ *
+ * @example
+ * RopeChunkIterator it;
+ * StringView chunk;
+ * rope_chunks_begin(&rope, &it);
+ * while (rope_chunks_next(&it, &chunk)) {
+ *     fwrite(chunk.ptr, 1, chunk.len, file);
+ * }
+ */
+void rope_chunks_begin(const Rope *rope, RopeChunkIterator *it);
+
+/**
+ * @brief Returns the next chunk of the rope.
+ *
+ * @return `true` if a chunk was returned, `false` once all chunks have been visited.
+ */
+bool rope_chunks_next(RopeChunkIterator *it, StringView *chunk);
+
+/**
+ * @brief Appends the content of a rope to a malloc-allocated `String`, growing it at most once.
+ *
+ * @return `ARENA_SUCCESS`, or an error if the string could not grow.
+ */
+ArenaError rope_append_to_string_malloc(const Rope *rope, String *dest);
+
+/**
+ * @brief Appends the content of a rope to an arena-allocated `String`, growing it at most once.
+ *
+ * @param arena A pointer to the `Arena` if `dest` is arena-allocated. If NULL, it is assumed that `dest` is malloc-allocated.
+ * @return `ARENA_SUCCESS`, or an error if the string could not grow.
+ */
+ArenaError rope_append_to_string_arena(const Rope *rope, String *dest, Arena *arena);
+
+/**
+ * @brief Flattens a rope into a new malloc-allocated `String`.
+ *
+ * @return The new `String`, or NULL if allocation fails. Free it with `string_free`.
+ */
+String *rope_to_string_malloc(const Rope *rope);
+
+#endif // STRING_ROPE_H
@@ -1,11 +1,321 @@
 #include "c_string.h"
+#include "c_string_internal.h"
 #include <string.h>
 #include <memory.h>
 #include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdalign.h>
 #include <stdarg.h> // Needed for va_list (variable argument lists)
 #include <stdio.h> // Needed for vsnprintf
 
+// Points the string at its inline buffer and copies the given content into it.
+// The caller has to make sure that length + 1 fits into STRING_INLINE_CAPACITY.
+static void string_set_inline(String *str, const char *src, size_t length)
+{
+    str->data = str->inline_data;
+    str->length = length;
+    str->capacity = STRING_INLINE_CAPACITY;
+    str->hash = 0;
+    str->flags &= ~STRING_FLAG_POOLED_DATA;
+    if (length > 0) {
+        memcpy(str->data, src, length);
+    }
+    str->data[length] = '\0';
+}
+
+// Growth policy shared by the malloc, block and arena paths
+static StringGrowthPolicy string_growth_policy = {
+    .factor = STRING_DEFAULT_GROWTH_FACTOR,
+    .min_step = STRING_DEFAULT_GROWTH_MIN_STEP,
+    .page_size = STRING_DEFAULT_GROWTH_PAGE_SIZE,
+    .large_threshold = STRING_DEFAULT_GROWTH_LARGE_THRESHOLD,
+};
+
+// Returns the capacity a string should grow to when it needs at least required_capacity bytes.
+static size_t string_next_capacity(size_t current_capacity, size_t required_capacity)
+{
+    const StringGrowthPolicy *policy = &string_growth_policy;
+    size_t new_capacity = required_capacity;
+
+    // Geometric growth keeps repeated appends at amortized O(1)
+    double grown = (double)current_capacity * policy->factor;
+    if (grown < (double)(SIZE_MAX / 2) && (size_t)grown > new_capacity) {
+        new_capacity = (size_t)grown;
+    }
+
+    // Never grow by less than min_step, so tiny strings do not reallocate on every append
+    if (current_capacity <= SIZE_MAX - policy->min_step && current_capacity + policy->min_step > new_capacity) {
+        new_capacity = current_capacity + policy->min_step;
+    }
+
+    // Large buffers are rounded up to whole pages
+    if (policy->page_size > 0 && new_capacity >= policy->large_threshold) {
+        size_t rounded = (new_capacity + policy->page_size - 1) / policy->page_size * policy->page_size;
+        if (rounded >= new_capacity) {
+            new_capacity = rounded;
+        }
+    }
+
+    return new_capacity;
+}
+
+// Size of a single allocation holding the String header followed by capacity bytes of data.
+// The payload starts at inline_data, so the block is never smaller than a String.
+static size_t string_block_size(size_t capacity)
+{
+    size_t size = offsetof(String, inline_data) + capacity;
+    return size < sizeof(String) ? sizeof(String) : size;
+}
+
+// Capacity of a block string that has to hold length characters plus the null terminator.
+static size_t string_block_capacity(size_t length)
+{
+    return length + 1 < STRING_INLINE_CAPACITY ? STRING_INLINE_CAPACITY : length + 1;
+}
+
+// Sets up a string whose payload of capacity bytes starts at inline_data (see string_block_size).
+static void string_init_block(String *str, const char *src, size_t length, size_t capacity)
+{
+    str->data = str->inline_data;
+    str->length = length;
+    str->capacity = capacity;
+    str->hash = 0;
+    str->flags = 0;
+    if (length > 0) {
+        memcpy(str->data, src, length);
+    }
+    str->data[length] = '\0';
+}
+
+// Releases the separate data buffer of a malloc'ed or pooled string, if it has one
+static void string_free_data(String *string)
+{
+    if (string_is_inline(string)) {
+        return;
+    }
+    if (string->flags & STRING_FLAG_POOLED_DATA) {
+        string_pool_release_buffer(string->data);
+    } else {
+        free(string->data);
+    }
+}
+
+// Growth of strings from string_builder_acquire. Buffers come from the thread-local pool as long
+// as they fit into a size class, larger ones from malloc.
+static ArenaError string_resize_pooled(String *dest, size_t new_capacity)
+{
+    size_t capacity = new_capacity;
+    char *new_data = string_pool_acquire_buffer(new_capacity, &capacity);
+    bool pooled = new_data != NULL;
+
+    if (!pooled) {
+        if (!string_is_inline(dest) && !(dest->flags & STRING_FLAG_POOLED_DATA)) {
+            // Already outgrew the pool, keep using realloc
+            new_data = (char *)realloc(dest->data, new_capacity);
+            if (new_data == NULL) {
+                return ARENA_ERROR_REALLOCATION_FAILED;
+            }
+            dest->data = new_data;
+            dest->capacity = new_capacity;
+            return ARENA_SUCCESS;
+        }
+        new_data = (char *)malloc(new_capacity);
+        if (new_data == NULL) {
+            return ARENA_ERROR_ALLOCATION_FAILED;
+        }
+    }
+
+    memcpy(new_data, dest->data, dest->length + 1);
+    string_free_data(dest);
+    dest->data = new_data;
+    dest->capacity = capacity;
+    if (pooled) {
+        dest->flags |= STRING_FLAG_POOLED_DATA;
+    } else {
+        dest->flags &= ~STRING_FLAG_POOLED_DATA;
+    }
+    return ARENA_SUCCESS;
+}
+
+// Moves the content of a malloc'ed string into a buffer of exactly new_capacity bytes.
+// Inline strings are promoted to a heap buffer, heap strings are reallocated.
+static ArenaError string_resize_malloc(String *dest, size_t new_capacity)
+{
+    if (dest->flags & STRING_FLAG_POOLED_HEADER) {
+        return string_resize_pooled(dest, new_capacity);
+    }
+
+    if (string_is_inline(dest)) {
+        // Promote from the inline buffer to the heap
+        char *new_data = (char *)malloc(new_capacity);
+        if (new_data == NULL) {
+            return ARENA_ERROR_ALLOCATION_FAILED;
+        }
+        memcpy(new_data, dest->data, dest->length + 1);
+        dest->data = new_data;
+    } else {
+        char *new_data = (char *)realloc(dest->data, new_capacity);
+        if (new_data == NULL) {
+            return ARENA_ERROR_REALLOCATION_FAILED;
+        }
+        dest->data = new_data;
+    }
+
+    dest->capacity = new_capacity;
+    return ARENA_SUCCESS;
+}
+
+// Grows a malloc'ed string so it can hold at least required_capacity bytes.
+static ArenaError string_grow_malloc(String *dest, size_t required_capacity)
+{
+    if (required_capacity <= dest->capacity) {
+        return ARENA_SUCCESS;
+    }
+
+    return string_resize_malloc(dest, string_next_capacity(dest->capacity, required_capacity));
+}
+
+// Gives an arena string room for at least new_capacity bytes.
+static ArenaError string_resize_arena(String *dest, size_t new_capacity, Arena *arena)
+{
+    // Ask the arena for the missing bytes. If the string was the most recent allocation they land
+    // directly behind it and the string simply grows in place. This also covers strings whose
+    // payload directly follows their header (see new_string_arena).
+    size_t missing = new_capacity - dest->capacity;
+    char *tail = arena_allocate(arena, missing, alignof(char));
+    if (!tail) {
+        return ARENA_ERROR_ALLOCATION_FAILED;
+    }
+    if (tail == dest->data + dest->capacity) {
+        dest->capacity = new_capacity;
+        return ARENA_SUCCESS;
+    }
+
+    // Somebody allocated after the string, relocate it into one fresh buffer. The probe bytes are
+    // the only ones lost until the arena is reset, the old bytes stay untouched so we never move
+    // or invalidate other allocations in the arena.
+    char *new_data = arena_allocate(arena, new_capacity, alignof(char));
+    if (!new_data) {
+        return ARENA_ERROR_ALLOCATION_FAILED;
+    }
+
+    memcpy(new_data, dest->data, dest->length + 1);
+    dest->data = new_data;
+    dest->capacity = new_capacity;
+    return ARENA_SUCCESS;
+}
+
+ArenaError string_grow_arena(String *dest, size_t required_capacity, Arena *arena)
+{
+    if (!arena) {
+        return string_grow_malloc(dest, required_capacity);
+    }
+
+    if (required_capacity <= dest->capacity) {
+        return ARENA_SUCCESS;
+    }
+
+    return string_resize_arena(dest, string_next_capacity(dest->capacity, required_capacity), arena);
+}
+
+// Gives a chunk arena string room for at least new_capacity bytes.
+static ArenaError string_resize_chunk_arena(String *dest, size_t new_capacity, ChunkArena *arena)
+{
+    // The most recent allocation of the current block can simply be extended, this includes
+    // strings whose payload directly follows their header
+    if (chunk_arena_try_extend(arena, dest->data, dest->capacity, new_capacity)) {
+        dest->capacity = new_capacity;
+        return ARENA_SUCCESS;
+    }
+
+    // Otherwise copy into a fresh buffer, existing allocations never move
+    char *new_data = chunk_arena_allocate(arena, new_capacity, alignof(char));
+    if (!new_data) {
+        return ARENA_ERROR_ALLOCATION_FAILED;
+    }
+    memcpy(new_data, dest->data, dest->length + 1);
+    dest->data = new_data;
+    dest->capacity = new_capacity;
+    return ARENA_SUCCESS;
+}
+
+void string_set_growth_policy(const StringGrowthPolicy *policy)
+{
+    if (policy == NULL) {
+        string_growth_policy.factor = STRING_DEFAULT_GROWTH_FACTOR;
+        string_growth_policy.min_step = STRING_DEFAULT_GROWTH_MIN_STEP;
+        string_growth_policy.page_size = STRING_DEFAULT_GROWTH_PAGE_SIZE;
+        string_growth_policy.large_threshold = STRING_DEFAULT_GROWTH_LARGE_THRESHOLD;
+        return;
+    }
+
+    string_growth_policy = *policy;
+
+    // A factor below 1 would shrink, growth then only happens by the required amount
+    if (!(string_growth_policy.factor >= 1.0)) {
+        string_growth_policy.factor = 1.0;
+    }
+}
+
+StringGrowthPolicy string_get_growth_policy(void)
+{
+    return string_growth_policy;
+}
+
+ArenaError string_reserve_malloc(String *string, size_t capacity)
+{
+    if (capacity + 1 <= string->capacity) { // +1 for the null terminator
+        return ARENA_SUCCESS;
+    }
+
+    return string_resize_malloc(string, capacity + 1);
+}
+
+ArenaError string_reserve_arena(String *string, size_t capacity, Arena *arena)
+{
+    if (!arena) {
+        return string_reserve_malloc(string, capacity);
+    }
+
+    if (capacity + 1 <= string->capacity) {
+        return ARENA_SUCCESS;
+    }
+
+    return string_resize_arena(string, capacity + 1, arena);
+}
+
+ArenaError string_reserve_chunk_arena(String *string, size_t capacity, ChunkArena *arena)
+{
+    if (capacity + 1 <= string->capacity) {
+        return ARENA_SUCCESS;
+    }
+
+    return string_resize_chunk_arena(string, capacity + 1, arena);
+}
+
+ArenaError string_shrink_to_fit_malloc(String *string)
+{
+    // Inline (and block) strings have no separate buffer to give back
+    if (string_is_inline(string)) {
+        return ARENA_SUCCESS;
+    }
+
+    // Short enough to move back into the inline buffer
+    if (string->length < STRING_INLINE_CAPACITY) {
+        String old = *string;
+        string_set_inline(string, old.data, old.length);
+        string_free_data(&old);
+        return ARENA_SUCCESS;
+    }
+
+    if (string->capacity == string->length + 1) {
+        return ARENA_SUCCESS;
+    }
+
+    return string_resize_malloc(string, string->length + 1);
+}
+
 String *new_string_malloc(const char *initial_str)
 {
     String *str = (String *)malloc(sizeof(String));
@@ -14,43 +324,149 @@ String *new_string_malloc(const char *initial_str)
         return NULL;
     }
 
+    if (!string_init(str, initial_str)) {
+        free(str);
+        return NULL;
+    }
+
+    return str;
+}
+
+bool string_init(String *string, const char *initial_str)
+{
     // Here we get the inital length of our provided inital string, 
     // if we didnt provide one and the pointer is set to null ,
     // we set the length to 0 
     size_t length_of_initial_str = initial_str ? strlen(initial_str) : 0;
-    str->data = (char *)malloc(length_of_initial_str + 1);
-    str->length = length_of_initial_str;
-    str->capacity = length_of_initial_str + 1; // Capacity is one more for null terminator
-    
-    if (str->data == NULL){
-        free(str);
-        return NULL;
+    string->flags = 0;
+
+    // Short strings never touch the heap
+    if (length_of_initial_str < STRING_INLINE_CAPACITY) {
+        string_set_inline(string, initial_str, length_of_initial_str);
+        return true;
     }
 
-    strcpy_s(str->data, str->capacity, initial_str ? initial_str : "");
+    string->data = (char *)malloc(length_of_initial_str + 1);
+    if (string->data == NULL){
+        return false;
+    }
 
-    return str;
+    string->length = length_of_initial_str;
+    string->capacity = length_of_initial_str + 1; // Capacity is one more for null terminator
+    string->hash = 0;
+    memcpy(string->data, initial_str, length_of_initial_str + 1);
+
+    return true;
 }
 
-String *new_string_arena(const char *initial_str, Arena *arena) {
-    String *str = arena_allocate(arena, sizeof(String), alignof(String)); // Use arena_alloc
-    if (!str) return NULL;  
+void string_destroy(String *string)
+{
+    string_free_data(string);
+    string_set_inline(string, NULL, 0);
+}
+
+bool string_is_inline(const String *string)
+{
+    return string->data == string->inline_data;
+}
 
+String *new_string_block(const char *initial_str)
+{
     size_t length_of_initial_str = initial_str ? strlen(initial_str) : 0;
-    str->data = arena_allocate(arena, length_of_initial_str + 1, alignof(char)); // Use arena_alloc for string data
-    if (!str->data) {
-        // Handle allocation failure for str->data (potentially reset arena and return NULL)
-        arena_reset(arena); // This would undo the allocation of the String struct itself
+    size_t capacity = string_block_capacity(length_of_initial_str);
+
+    // Header and payload share one allocation, the payload starts at inline_data
+    String *str = (String *)malloc(string_block_size(capacity));
+    if (str == NULL) {
         return NULL;
     }
 
-    str->length = length_of_initial_str;
-    str->capacity = length_of_initial_str + 1; 
+    string_init_block(str, initial_str, length_of_initial_str, capacity);
+    return str;
+}
+
+String *string_append_bytes_block(String *dest, const char *src, size_t src_len)
+{
+    size_t new_length = dest->length + src_len;
+
+    if (new_length + 1 > dest->capacity) {
+        size_t src_offset = 0;
+        bool aliased = string_contains_pointer(dest, src, &src_offset);
+
+        if (!string_is_inline(dest)) {
+            // The payload already left the block (e.g. grown by string_append_char_array_malloc),
+            // so only the separate data buffer has to grow.
+            if (string_grow_malloc(dest, new_length + 1) != ARENA_SUCCESS) {
+                return NULL;
+            }
+        } else {
+            size_t new_capacity = string_next_capacity(dest->capacity, new_length + 1);
+
+            // Reallocate header and payload together, the block may move
+            String *new_block = (String *)realloc(dest, string_block_size(new_capacity));
+            if (new_block == NULL) {
+                return NULL;
+            }
+            dest = new_block;
+            dest->data = dest->inline_data;
+            dest->capacity = new_capacity;
+        }
+
+        if (aliased) {
+            src = dest->data + src_offset;
+        }
+    }
+
+    if (src_len > 0) {
+        memcpy(dest->data + dest->length, src, src_len);
+    }
+    dest->length = new_length;
+    dest->data[dest->length] = '\0';
+    dest->hash = 0;
+
+    return dest;
+}
+
+String *string_append_char_array_block(String *dest, const char *src)
+{
+    return string_append_bytes_block(dest, src, strlen(src));
+}
+
+String *string_append_string_block(String *dest, const String *src)
+{
+    return string_append_bytes_block(dest, src->data, src->length);
+}
 
-    strcpy_s(str->data, str->capacity, initial_str ? initial_str : "");
+String *new_string_arena(const char *initial_str, Arena *arena) {
+    size_t length_of_initial_str = initial_str ? strlen(initial_str) : 0;
+    size_t capacity = string_block_capacity(length_of_initial_str);
+
+    // Header and data come from a single allocation, so there is only one point of failure
+    // and nothing that would have to be rolled back
+    String *str = arena_allocate(arena, string_block_size(capacity), alignof(String)); // Use arena_alloc
+    if (!str) return NULL;  
+
+    string_init_block(str, initial_str, length_of_initial_str, capacity);
     return str;
 }
 
+String *string_new_bytes_chunk_arena(const char *bytes, size_t length, ChunkArena *arena)
+{
+    size_t capacity = string_block_capacity(length);
+
+    String *str = chunk_arena_allocate(arena, string_block_size(capacity), alignof(String));
+    if (!str) return NULL;
+
+    string_init_block(str, bytes, length, capacity);
+    return str;
+}
+
+String *new_string_chunk_arena(const char *initial_str, ChunkArena *arena)
+{
+    size_t length_of_initial_str = initial_str ? strlen(initial_str) : 0;
+    return string_new_bytes_chunk_arena(initial_str, length_of_initial_str, arena);
+}
+
 char string_char_at_index(const String *string, size_t index)
 {
     if(index > string->length){
@@ -60,87 +476,316 @@ char string_char_at_index(const String *string, size_t index)
     return string->data[index];
 }
 
-ArenaError string_append_char_array_arena(String *dest, const char *src, Arena *arena) {
+ArenaError string_append_bytes_arena(String *dest, const char *src, size_t src_len, Arena *arena) {
     
-    size_t src_len = strlen(src);
     size_t new_length = dest->length + src_len;
+    size_t src_offset = 0;
+    bool aliased = string_contains_pointer(dest, src, &src_offset);
 
-    // Check if we need to grow the arena (only if using arena allocation)
-    if (arena && new_length + 1 > dest->capacity) { // +1 for null terminator
-        ArenaError grow_result = arena_grow(arena, new_length + 1 - dest->capacity);
-        if (grow_result != ARENA_SUCCESS) {
-            // Handle the error (e.g., report to the user)
-            return grow_result;
-        }
-
-        // Update capacity after successful growth
-        dest->capacity = arena->size - (dest->data - arena->start); // Calculate new capacity within the arena
+    ArenaError grow_result = string_grow_arena(dest, new_length + 1, arena); // +1 for null terminator
+    if (grow_result != ARENA_SUCCESS) {
+        return grow_result;
     }
 
-    // If the string is malloc'ed and needs to grow
-    if (!arena && new_length + 1 > dest->capacity) {
-        size_t new_capacity = dest->capacity * 2; 
-        if (new_capacity < new_length + 1) {
-            new_capacity = new_length + 1;
-        }
-
-        char *new_data = (char*)realloc(dest->data, new_capacity);
-        if (!new_data) {
-            // Handle allocation failure (e.g., return an error code)
-            return ARENA_ERROR_REALLOCATION_FAILED;
-        }
-        dest->data = new_data;
-        dest->capacity = new_capacity;
+    // Appending a part of the string to itself, the data may have moved
+    if (aliased) {
+        src = dest->data + src_offset;
     }
     
     // Append source
-    memcpy(dest->data + dest->length, src, src_len); // Use memcpy for efficiency
+    if (src_len > 0) {
+        memcpy(dest->data + dest->length, src, src_len); // Use memcpy for efficiency
+    }
     dest->length = new_length;
 
     // Add null terminator
     dest->data[dest->length] = '\0';
+    dest->hash = 0;
     return ARENA_SUCCESS;
 }
 
-// Function to append a char array to a string struct
-void string_append_char_array_malloc(String *dest, const char *src) {
-    size_t src_len = strlen(src);
-
-    // Ensure sufficient capacity
-    if (dest->length + src_len + 1 > dest->capacity) { // +1 for the null terminator
-        // Double the capacity (or increase it by some amount)
-        size_t new_capacity = dest->capacity * 2;
-        if (new_capacity < dest->length + src_len + 1) {
-            new_capacity = dest->length + src_len + 1; 
-        }
-        
-        // Reallocate memory
-        char *new_data = (char*)realloc(dest->data, new_capacity);
-        if (new_data == NULL) {
-            // Memory allocation failed. Handle the error appropriately.
-            // (e.g., print an error message, return an error code, etc.)
-            return; 
+ArenaError string_append_char_array_arena(String *dest, const char *src, Arena *arena) {
+    return string_append_bytes_arena(dest, src, strlen(src), arena);
+}
+
+ArenaError string_append_bytes_chunk_arena(String *dest, const char *src, size_t src_len, ChunkArena *arena)
+{
+    size_t new_length = dest->length + src_len;
+    size_t src_offset = 0;
+    bool aliased = string_contains_pointer(dest, src, &src_offset);
+
+    if (new_length + 1 > dest->capacity) {
+        ArenaError grow_result = string_resize_chunk_arena(dest, string_next_capacity(dest->capacity, new_length + 1), arena);
+        if (grow_result != ARENA_SUCCESS) {
+            return grow_result;
         }
-        dest->data = new_data;
-        dest->capacity = new_capacity;
+        if (aliased) {
+            src = dest->data + src_offset;
+        }
+    }
+
+    if (src_len > 0) {
+        memcpy(dest->data + dest->length, src, src_len);
     }
+    dest->length = new_length;
+    dest->data[dest->length] = '\0';
+    dest->hash = 0;
+    return ARENA_SUCCESS;
+}
 
-    // Copy the source string
-    strcpy_s(dest->data + dest->length, dest->capacity - dest->length, src);
+ArenaError string_append_char_array_chunk_arena(String *dest, const char *src, ChunkArena *arena)
+{
+    return string_append_bytes_chunk_arena(dest, src, strlen(src), arena);
+}
+
+ArenaError string_append_string_chunk_arena(String *dest, const String *src, ChunkArena *arena)
+{
+    return string_append_bytes_chunk_arena(dest, src->data, src->length, arena);
+}
+
+ArenaError string_append_bytes_malloc(String *dest, const char *src, size_t src_len) {
+    size_t src_offset = 0;
+    bool aliased = string_contains_pointer(dest, src, &src_offset);
+
+    // Ensure sufficient capacity, inline strings are promoted to the heap here
+    ArenaError grow_result = string_grow_malloc(dest, dest->length + src_len + 1); // +1 for the null terminator
+    if (grow_result != ARENA_SUCCESS) {
+        return grow_result;
+    }
+
+    // realloc may have moved the buffer we are copying from
+    if (aliased) {
+        src = dest->data + src_offset;
+    }
+
+    // Copy the source bytes, they do not need to be null terminated
+    if (src_len > 0) {
+        memcpy(dest->data + dest->length, src, src_len);
+    }
     dest->length += src_len;
 
     // Add null terminator
     dest->data[dest->length] = '\0';
+    dest->hash = 0;
+    return ARENA_SUCCESS;
+}
+
+// Function to append a char array to a string struct
+void string_append_char_array_malloc(String *dest, const char *src) {
+    // Memory allocation failures leave dest unchanged
+    string_append_bytes_malloc(dest, src, strlen(src));
 }
 
 void string_append_string_malloc(String *dest, const String *src)
 {
-    string_append_char_array_malloc(dest, src->data);
+    // The length is already known, no need to scan src again
+    string_append_bytes_malloc(dest, src->data, src->length);
 }
 
 void string_append_string_arena(String *dest, const String *src, Arena *arena)
 {
-    string_append_char_array_arena(dest, src->data, arena);
+    string_append_bytes_arena(dest, src->data, src->length, arena);
+}
+
+// The kinds of part arrays accepted by the bulk concatenation functions
+typedef enum
+{
+    STRING_PARTS_CHAR_ARRAY, // const char *const *
+    STRING_PARTS_VIEW,       // const StringView *
+    STRING_PARTS_STRING,     // const String *const *
+} StringPartsKind;
+
+// Lengths of the first parts are remembered between the sizing and the copying pass,
+// so null terminated parts are usually only scanned once
+#define STRING_CONCAT_LENGTH_CACHE 64
+
+static StringView string_concat_part(const void *parts, StringPartsKind kind, size_t index)
+{
+    switch (kind) {
+    case STRING_PARTS_CHAR_ARRAY:
+        return string_view_from_cstr(((const char *const *)parts)[index]);
+    case STRING_PARTS_VIEW:
+        return ((const StringView *)parts)[index];
+    case STRING_PARTS_STRING:
+    default:
+        return string_view_from_string(((const String *const *)parts)[index]);
+    }
+}
+
+// Appends all parts (with separator in between) after growing dest exactly once.
+static ArenaError string_join_parts(String *dest, StringView separator, const void *parts, StringPartsKind kind,
+                                    size_t count, Arena *arena)
+{
+    if (count == 0) {
+        return ARENA_SUCCESS;
+    }
+
+    size_t lengths[STRING_CONCAT_LENGTH_CACHE];
+
+    // First pass: the total length, a sum that does not fit in size_t can never be allocated
+    if (separator.len > 0 && count - 1 > SIZE_MAX / separator.len) {
+        return ARENA_ERROR_ALLOCATION_FAILED;
+    }
+    size_t total = separator.len * (count - 1);
+    for (size_t i = 0; i < count; i++) {
+        size_t length = kind == STRING_PARTS_CHAR_ARRAY && i >= STRING_CONCAT_LENGTH_CACHE
+                            ? strlen(((const char *const *)parts)[i])
+                            : string_concat_part(parts, kind, i).len;
+        if (i < STRING_CONCAT_LENGTH_CACHE) {
+            lengths[i] = length;
+        }
+        if (length > SIZE_MAX - total) {
+            return ARENA_ERROR_ALLOCATION_FAILED;
+        }
+        total += length;
+    }
+    if (total > SIZE_MAX - 1 - dest->length) {
+        return ARENA_ERROR_ALLOCATION_FAILED;
+    }
+
+    // Parts and the separator may point into dest itself, remember where its data was before growing
+    const char *old_data = dest->data;
+    size_t old_capacity = dest->capacity;
+
+    ArenaError grow_result = string_grow_arena(dest, dest->length + total + 1, arena);
+    if (grow_result != ARENA_SUCCESS) {
+        return grow_result;
+    }
+    if ((uintptr_t)separator.ptr >= (uintptr_t)old_data && (uintptr_t)separator.ptr < (uintptr_t)old_data + old_capacity) {
+        separator.ptr = dest->data + (separator.ptr - old_data);
+    }
+
+    // Second pass: copy, nothing can reallocate anymore
+    char *out = dest->data + dest->length;
+    for (size_t i = 0; i < count; i++) {
+        StringView part;
+        if (kind == STRING_PARTS_CHAR_ARRAY && i < STRING_CONCAT_LENGTH_CACHE) {
+            part = string_view_from_bytes(((const char *const *)parts)[i], lengths[i]);
+        } else {
+            part = string_concat_part(parts, kind, i);
+        }
+        if ((uintptr_t)part.ptr >= (uintptr_t)old_data && (uintptr_t)part.ptr < (uintptr_t)old_data + old_capacity) {
+            part.ptr = dest->data + (part.ptr - old_data);
+        }
+
+        if (i > 0 && separator.len > 0) {
+            memcpy(out, separator.ptr, separator.len);
+            out += separator.len;
+        }
+        if (part.len > 0) {
+            memcpy(out, part.ptr, part.len);
+            out += part.len;
+        }
+    }
+
+    dest->length += total;
+    dest->data[dest->length] = '\0';
+    dest->hash = 0;
+    return ARENA_SUCCESS;
+}
+
+ArenaError string_concat_n_arena(String *dest, const char *const *parts, size_t count, Arena *arena)
+{
+    return string_join_parts(dest, string_view_from_bytes(NULL, 0), parts, STRING_PARTS_CHAR_ARRAY, count, arena);
+}
+
+ArenaError string_concat_views_arena(String *dest, const StringView *parts, size_t count, Arena *arena)
+{
+    return string_join_parts(dest, string_view_from_bytes(NULL, 0), parts, STRING_PARTS_VIEW, count, arena);
+}
+
+ArenaError string_concat_strings_arena(String *dest, const String *const *parts, size_t count, Arena *arena)
+{
+    return string_join_parts(dest, string_view_from_bytes(NULL, 0), parts, STRING_PARTS_STRING, count, arena);
+}
+
+ArenaError string_join_arena(String *dest, StringView separator, const StringView *parts, size_t count, Arena *arena)
+{
+    return string_join_parts(dest, separator, parts, STRING_PARTS_VIEW, count, arena);
+}
+
+ArenaError string_join_strings_arena(String *dest, StringView separator, const String *const *parts, size_t count, Arena *arena)
+{
+    return string_join_parts(dest, separator, parts, STRING_PARTS_STRING, count, arena);
+}
+
+ArenaError string_concat_n_malloc(String *dest, const char *const *parts, size_t count)
+{
+    return string_concat_n_arena(dest, parts, count, NULL);
+}
+
+ArenaError string_concat_views_malloc(String *dest, const StringView *parts, size_t count)
+{
+    return string_concat_views_arena(dest, parts, count, NULL);
+}
+
+ArenaError string_concat_strings_malloc(String *dest, const String *const *parts, size_t count)
+{
+    return string_concat_strings_arena(dest, parts, count, NULL);
+}
+
+ArenaError string_join_malloc(String *dest, StringView separator, const StringView *parts, size_t count)
+{
+    return string_join_arena(dest, separator, parts, count, NULL);
+}
+
+ArenaError string_join_strings_malloc(String *dest, StringView separator, const String *const *parts, size_t count)
+{
+    return string_join_strings_arena(dest, separator, parts, count, NULL);
+}
+
+int string_vappendf_arena(String *dest, Arena *arena, const char *format, va_list args)
+{
+    // Keep a copy of the arguments, vsnprintf consumes them and we may need a second attempt
+    va_list retry;
+    va_copy(retry, args);
+
+    // Format straight into the spare capacity of the string, arguments never point into it
+    size_t spare = dest->capacity - dest->length;
+    int written = vsnprintf(dest->data + dest->length, spare, format, args);
+    if (written < 0) {
+        dest->data[dest->length] = '\0';
+        va_end(retry);
+        return -1;
+    }
+
+    if ((size_t)written >= spare) {
+        // The output was truncated, grow once to the now known size and format again
+        if (string_grow_arena(dest, dest->length + (size_t)written + 1, arena) != ARENA_SUCCESS) {
+            dest->data[dest->length] = '\0';
+            va_end(retry);
+            return -1;
+        }
+        vsnprintf(dest->data + dest->length, (size_t)written + 1, format, retry);
+    }
+    va_end(retry);
+
+    dest->length += (size_t)written;
+    dest->hash = 0;
+    return written;
+}
+
+int string_appendf_arena(String *dest, Arena *arena, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int written = string_vappendf_arena(dest, arena, format, args);
+    va_end(args);
+    return written;
+}
+
+int string_vappendf_malloc(String *dest, const char *format, va_list args)
+{
+    return string_vappendf_arena(dest, NULL, format, args);
+}
+
+int string_appendf_malloc(String *dest, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int written = string_vappendf_arena(dest, NULL, format, args);
+    va_end(args);
+    return written;
 }
 
 size_t string_length(String *string)
@@ -150,6 +795,117 @@ size_t string_length(String *string)
 
 void string_free(String *string)
 {
-    free(string->data);
-    free(string);
-}
\ No newline at end of file
+    string_free_data(string);
+    if (string->flags & STRING_FLAG_POOLED_HEADER) {
+        string_pool_release_buffer((char *)string);
+    } else {
+        free(string);
+    }
+}
+
+// ASCII whitespace as recognized by isspace in the "C" locale
+static bool string_is_space(char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+StringView string_view_from_string(const String *string)
+{
+    StringView view = { string->data, string->length };
+    return view;
+}
+
+StringView string_view_from_cstr(const char *str)
+{
+    StringView view = { str ? str : "", str ? strlen(str) : 0 };
+    return view;
+}
+
+StringView string_view_from_bytes(const char *ptr, size_t len)
+{
+    StringView view = { ptr, len };
+    return view;
+}
+
+StringView string_slice(const String *string, size_t start, size_t length)
+{
+    return string_view_slice(string_view_from_string(string), start, length);
+}
+
+StringView string_view_slice(StringView view, size_t start, size_t length)
+{
+    if (start > view.len) {
+        start = view.len;
+    }
+    if (length > view.len - start) {
+        length = view.len - start;
+    }
+
+    StringView slice = { view.ptr + start, length };
+    return slice;
+}
+
+// Whitespace runs longer than this are skipped with the vectorized set search
+#define STRING_TRIM_SCALAR_RUN 16
+
+static const StringView string_whitespace = { " \t\n\v\f\r", 6 };
+
+StringView string_view_trim_left(StringView view)
+{
+    size_t start = 0;
+    while (start < view.len && start < STRING_TRIM_SCALAR_RUN && string_is_space(view.ptr[start])) {
+        start++;
+    }
+    if (start == STRING_TRIM_SCALAR_RUN) {
+        start = string_view_find_first_not_of(view, string_whitespace, start);
+    }
+    return string_view_slice(view, start, STRING_NPOS);
+}
+
+StringView string_view_trim_right(StringView view)
+{
+    size_t end = view.len;
+    while (end > 0 && view.len - end < STRING_TRIM_SCALAR_RUN && string_is_space(view.ptr[end - 1])) {
+        end--;
+    }
+    if (end > 0 && view.len - end == STRING_TRIM_SCALAR_RUN) {
+        size_t last = string_view_find_last_not_of(view, string_whitespace, end - 1);
+        end = last == STRING_NPOS ? 0 : last + 1;
+    }
+    return string_view_slice(view, 0, end);
+}
+
+StringView string_view_trim(StringView view)
+{
+    return string_view_trim_right(string_view_trim_left(view));
+}
+
+bool string_view_starts_with(StringView view, StringView prefix)
+{
+    return prefix.len <= view.len && (prefix.len == 0 || memcmp(view.ptr, prefix.ptr, prefix.len) == 0);
+}
+
+bool string_view_ends_with(StringView view, StringView suffix)
+{
+    return suffix.len <= view.len &&
+           (suffix.len == 0 || memcmp(view.ptr + view.len - suffix.len, suffix.ptr, suffix.len) == 0);
+}
+
+bool string_view_equals(StringView a, StringView b)
+{
+    // Different lengths can never be equal, no need to look at the bytes
+    if (a.len != b.len) {
+        return false;
+    }
+    return a.len == 0 || a.ptr == b.ptr || memcmp(a.ptr, b.ptr, a.len) == 0;
+}
+
+int string_view_compare(StringView a, StringView b)
+{
+    size_t common = a.len < b.len ? a.len : b.len;
+    int result = common ? memcmp(a.ptr, b.ptr, common) : 0;
+    if (result != 0) {
+        return result;
+    }
+    return (a.len > b.len) - (a.len < b.len);
+}
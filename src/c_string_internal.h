@@ -0,0 +1,88 @@
+// Internal functions shared between the source files of the library. Not part of the public API.
+
+#ifndef C_STRING_INTERNAL_H
+#define C_STRING_INTERNAL_H
+
+#include "c_string.h"
+#include <stdint.h>
+
+#if defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+// Grows dest so it can hold at least required_capacity bytes (including the null terminator),
+// following the global growth policy. A NULL arena means dest is malloc'ed.
+ArenaError string_grow_arena(String *dest, size_t required_capacity, Arena *arena);
+
+// Creates a block string in a chunk arena from length bytes, which may contain null bytes.
+String *string_new_bytes_chunk_arena(const char *bytes, size_t length, ChunkArena *arena);
+
+// Takes a buffer of at least size bytes from the calling thread's pool (string_pool.c) and stores
+// its real size in *capacity. Returns NULL if size is above STRING_POOL_MAX_BUFFER or allocation fails.
+char *string_pool_acquire_buffer(size_t size, size_t *capacity);
+
+// Gives a buffer from string_pool_acquire_buffer back to the pool of the thread that took it.
+void string_pool_release_buffer(char *buffer);
+
+// Checks whether ptr points into the data buffer of string, e.g. when a string is appended to itself.
+// If so, offset receives the position of ptr relative to string->data.
+static inline bool string_contains_pointer(const String *string, const char *ptr, size_t *offset)
+{
+    uintptr_t begin = (uintptr_t)string->data;
+    uintptr_t p = (uintptr_t)ptr;
+    if (p >= begin && p < begin + string->capacity) {
+        *offset = (size_t)(p - begin);
+        return true;
+    }
+    return false;
+}
+
+// Number of leading zero bits, x must not be 0
+static inline int cs_clz64(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(x);
+#else
+    int n = 0;
+    while (!(x & (UINT64_C(1) << 63))) {
+        x <<= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+// Full 64x64 -> 128 bit multiplication, the high half is stored in *high
+static inline uint64_t cs_mul128(uint64_t a, uint64_t b, uint64_t *high)
+{
+#if defined(__SIZEOF_INT128__)
+    __uint128_t product = (__uint128_t)a * b;
+    *high = (uint64_t)(product >> 64);
+    return (uint64_t)product;
+#elif defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+    return _umul128(a, b, high);
+#else
+    uint64_t a_lo = (uint32_t)a, a_hi = a >> 32;
+    uint64_t b_lo = (uint32_t)b, b_hi = b >> 32;
+    uint64_t lo_lo = a_lo * b_lo;
+    uint64_t hi_lo = a_hi * b_lo;
+    uint64_t lo_hi = a_lo * b_hi;
+    uint64_t hi_hi = a_hi * b_hi;
+    uint64_t cross = (lo_lo >> 32) + (uint32_t)hi_lo + lo_hi;
+    *high = hi_hi + (hi_lo >> 32) + (cross >> 32);
+    return (cross << 32) | (uint32_t)lo_lo;
+#endif
+}
+
+// ASCII case folding, bytes outside A-Z and a-z are returned unchanged
+static inline unsigned char cs_ascii_lower(unsigned char c)
+{
+    return (unsigned char)(c - 'A') < 26u ? (unsigned char)(c | 0x20) : c;
+}
+
+static inline unsigned char cs_ascii_upper(unsigned char c)
+{
+    return (unsigned char)(c - 'a') < 26u ? (unsigned char)(c & ~0x20) : c;
+}
+
+#endif // C_STRING_INTERNAL_H
@@ -0,0 +1,98 @@
+// Internal helpers shared by the vectorized code paths of the library. Not part of the public API.
+//
+// SSE2 is part of every x86-64 target, so it is used whenever the compiler targets it.
+// AVX2 code is compiled with a target attribute and only called after a runtime CPU check,
+// this is available with GCC and Clang on x86. Every vectorized function has a scalar fallback.
+
+#ifndef C_STRING_SIMD_H
+#define C_STRING_SIMD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define C_STRING_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(C_STRING_HAVE_SSE2) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define C_STRING_HAVE_AVX2_DISPATCH 1
+#include <immintrin.h>
+#define C_STRING_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// Index of the lowest set bit, x must not be 0
+static inline unsigned cs_ctz32(uint32_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctz(x);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, x);
+    return (unsigned)index;
+#else
+    unsigned n = 0;
+    while (!(x & 1u)) {
+        x >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+// Index of the highest set bit, x must not be 0
+static inline unsigned cs_msb32(uint32_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return 31u - (unsigned)__builtin_clz(x);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse(&index, x);
+    return (unsigned)index;
+#else
+    unsigned n = 0;
+    while (x >>= 1) {
+        n++;
+    }
+    return n;
+#endif
+}
+
+#ifdef C_STRING_HAVE_SSE2
+// 0xFF for every byte in [first, last], which must both be ASCII. Signed compares are fine
+// because bytes from 0x80 are negative and never fall into the range.
+static inline __m128i cs_byte_range_sse2(__m128i bytes, char first, char last)
+{
+    return _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8((char)(first - 1))),
+                         _mm_cmplt_epi8(bytes, _mm_set1_epi8((char)(last + 1))));
+}
+#endif
+
+// Number of set bits
+static inline unsigned cs_popcount32(uint32_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_popcount(x);
+#else
+    x = x - ((x >> 1) & 0x55555555u);
+    x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+    x = (x + (x >> 4)) & 0x0F0F0F0Fu;
+    return (x * 0x01010101u) >> 24;
+#endif
+}
+
+// Whether the AVX2 code paths may be used on this CPU
+static inline bool cs_cpu_has_avx2(void)
+{
+#if defined(C_STRING_HAVE_AVX2_DISPATCH)
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+#endif // C_STRING_SIMD_H
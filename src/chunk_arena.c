@@ -0,0 +1,165 @@
+#include "chunk_arena.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+// Creates a block with room for size bytes and puts it in front of the block list.
+static ChunkArenaBlock *chunk_arena_new_block(ChunkArena *arena, size_t size)
+{
+    if (size > SIZE_MAX - sizeof(ChunkArenaBlock)) {
+        return NULL;
+    }
+
+    ChunkArenaBlock *block = (ChunkArenaBlock *)malloc(sizeof(ChunkArenaBlock) + size);
+    if (block == NULL) {
+        return NULL;
+    }
+
+    block->next = arena->head;
+    block->size = size;
+    block->used = 0;
+    arena->head = block;
+    return block;
+}
+
+// Returns the offset of the next allocation with the given alignment inside block,
+// or SIZE_MAX if size bytes do not fit anymore.
+static size_t chunk_arena_fit(const ChunkArenaBlock *block, size_t size, size_t alignment)
+{
+    uintptr_t base = (uintptr_t)block->data;
+    uintptr_t next = base + block->used;
+    uintptr_t aligned = (next + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    size_t offset = (size_t)(aligned - base);
+
+    if (offset > block->size || block->size - offset < size) {
+        return SIZE_MAX;
+    }
+    return offset;
+}
+
+void chunk_arena_init(ChunkArena *arena, size_t block_size)
+{
+    arena->head = NULL;
+    arena->current = NULL;
+    arena->block_size = block_size ? block_size : CHUNK_ARENA_DEFAULT_BLOCK_SIZE;
+}
+
+void *chunk_arena_allocate(ChunkArena *arena, size_t size, size_t alignment)
+{
+    if (alignment == 0) {
+        alignment = 1;
+    }
+
+    if (arena->current) {
+        size_t offset = chunk_arena_fit(arena->current, size, alignment);
+        if (offset != SIZE_MAX) {
+            arena->current->used = offset + size;
+            return arena->current->data + offset;
+        }
+    }
+
+    // Large allocations get a block of their own, the current block stays in use
+    if (size > arena->block_size / 4) {
+        if (size > SIZE_MAX - alignment) {
+            return NULL;
+        }
+        ChunkArenaBlock *block = chunk_arena_new_block(arena, size + alignment - 1);
+        if (block == NULL) {
+            return NULL;
+        }
+        size_t offset = chunk_arena_fit(block, size, alignment);
+        block->used = offset + size;
+        return block->data + offset;
+    }
+
+    ChunkArenaBlock *block = chunk_arena_new_block(arena, arena->block_size);
+    if (block == NULL) {
+        return NULL;
+    }
+    arena->current = block;
+
+    size_t offset = chunk_arena_fit(block, size, alignment);
+    block->used = offset + size;
+    return block->data + offset;
+}
+
+bool chunk_arena_try_extend(ChunkArena *arena, void *ptr, size_t old_size, size_t new_size)
+{
+    ChunkArenaBlock *block = arena->current;
+    if (block == NULL || new_size < old_size) {
+        return false;
+    }
+
+    // Only the allocation that ends at the bump pointer can grow
+    if ((unsigned char *)ptr + old_size != block->data + block->used) {
+        return false;
+    }
+
+    size_t additional = new_size - old_size;
+    if (block->size - block->used < additional) {
+        return false;
+    }
+
+    block->used += additional;
+    return true;
+}
+
+ChunkArenaMark chunk_arena_mark(const ChunkArena *arena)
+{
+    ChunkArenaMark mark;
+    mark.head = arena->head;
+    mark.current = arena->current;
+    mark.used = arena->current ? arena->current->used : 0;
+    return mark;
+}
+
+void chunk_arena_restore(ChunkArena *arena, ChunkArenaMark mark)
+{
+    // Every block created after the mark sits in front of mark.head
+    ChunkArenaBlock *block = arena->head;
+    while (block && block != mark.head) {
+        ChunkArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+
+    arena->head = mark.head;
+    arena->current = mark.current;
+    if (arena->current) {
+        arena->current->used = mark.used;
+    }
+}
+
+void chunk_arena_reset(ChunkArena *arena)
+{
+    // Keep one regular block around, so a reused arena does not hit malloc right away
+    ChunkArenaBlock *keep = NULL;
+    ChunkArenaBlock *block = arena->head;
+    while (block) {
+        ChunkArenaBlock *next = block->next;
+        if (keep == NULL && block->size == arena->block_size) {
+            keep = block;
+        } else {
+            free(block);
+        }
+        block = next;
+    }
+
+    if (keep) {
+        keep->next = NULL;
+        keep->used = 0;
+    }
+    arena->head = keep;
+    arena->current = keep;
+}
+
+void chunk_arena_free(ChunkArena *arena)
+{
+    ChunkArenaBlock *block = arena->head;
+    while (block) {
+        ChunkArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->head = NULL;
+    arena->current = NULL;
+}
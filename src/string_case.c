@@ -0,0 +1,147 @@
+// ASCII case conversion and table driven byte transforms.
+//
+// Case conversion flips the 0x20 bit of every letter of the other case. The kernels write
+// dst[i] from src[i] front to back, so dst may equal src or lie before it in the same buffer.
+
+#include "c_string.h"
+#include "c_string_internal.h"
+#include "c_string_simd.h"
+#include <string.h>
+
+#if defined(C_STRING_HAVE_AVX2_DISPATCH)
+C_STRING_TARGET_AVX2
+static size_t case_map_avx2(unsigned char *dst, const unsigned char *src, size_t len, char first, char last)
+{
+    const __m256i below = _mm256_set1_epi8((char)(first - 1));
+    const __m256i above = _mm256_set1_epi8((char)(last + 1));
+    const __m256i flip = _mm256_set1_epi8(0x20);
+    size_t i = 0;
+
+    for (; i + 32 <= len; i += 32) {
+        __m256i bytes = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i letters = _mm256_and_si256(_mm256_cmpgt_epi8(bytes, below), _mm256_cmpgt_epi8(above, bytes));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_xor_si256(bytes, _mm256_and_si256(letters, flip)));
+    }
+    return i;
+}
+#endif
+
+// Flips the case of every byte in [first, last], which is either A-Z or a-z
+static void case_map(unsigned char *dst, const unsigned char *src, size_t len, char first, char last)
+{
+    size_t i = 0;
+
+#if defined(C_STRING_HAVE_AVX2_DISPATCH)
+    if (len >= 32 && cs_cpu_has_avx2()) {
+        i = case_map_avx2(dst, src, len, first, last);
+    }
+#endif
+
+#ifdef C_STRING_HAVE_SSE2
+    const __m128i flip = _mm_set1_epi8(0x20);
+    for (; i + 16 <= len; i += 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i letters = cs_byte_range_sse2(bytes, first, last);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_xor_si128(bytes, _mm_and_si128(letters, flip)));
+    }
+#endif
+
+    for (; i < len; i++) {
+        unsigned char c = src[i];
+        dst[i] = (unsigned char)(c - (unsigned char)first) <= (unsigned char)(last - first) ? (unsigned char)(c ^ 0x20) : c;
+    }
+}
+
+static void table_map(unsigned char *dst, const unsigned char *src, size_t len, const unsigned char table[256])
+{
+    // A lookup per byte can not be vectorized without gathers, unrolling keeps the loads independent
+    size_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+        unsigned char a = table[src[i]], b = table[src[i + 1]], c = table[src[i + 2]], d = table[src[i + 3]];
+        dst[i] = a;
+        dst[i + 1] = b;
+        dst[i + 2] = c;
+        dst[i + 3] = d;
+    }
+    for (; i < len; i++) {
+        dst[i] = table[src[i]];
+    }
+}
+
+void string_to_lower_ascii(String *string)
+{
+    case_map((unsigned char *)string->data, (const unsigned char *)string->data, string->length, 'A', 'Z');
+    string->hash = 0;
+}
+
+void string_to_upper_ascii(String *string)
+{
+    case_map((unsigned char *)string->data, (const unsigned char *)string->data, string->length, 'a', 'z');
+    string->hash = 0;
+}
+
+void string_transform_bytes(String *string, const unsigned char table[256])
+{
+    table_map((unsigned char *)string->data, (const unsigned char *)string->data, string->length, table);
+    string->hash = 0;
+}
+
+// A source inside dest lies within its length, so dest does not grow and the source never moves
+static ArenaError string_copy_prepare(String *dest, StringView src, Arena *arena)
+{
+    return string_grow_arena(dest, src.len + 1, arena);
+}
+
+static void string_copy_finish(String *dest, size_t length)
+{
+    dest->length = length;
+    dest->data[length] = '\0';
+    dest->hash = 0;
+}
+
+static ArenaError string_copy_case(String *dest, StringView src, char first, char last, Arena *arena)
+{
+    ArenaError grow_result = string_copy_prepare(dest, src, arena);
+    if (grow_result != ARENA_SUCCESS) {
+        return grow_result;
+    }
+    case_map((unsigned char *)dest->data, (const unsigned char *)src.ptr, src.len, first, last);
+    string_copy_finish(dest, src.len);
+    return ARENA_SUCCESS;
+}
+
+ArenaError string_copy_lower_ascii_arena(String *dest, StringView src, Arena *arena)
+{
+    return string_copy_case(dest, src, 'A', 'Z', arena);
+}
+
+ArenaError string_copy_lower_ascii_malloc(String *dest, StringView src)
+{
+    return string_copy_lower_ascii_arena(dest, src, NULL);
+}
+
+ArenaError string_copy_upper_ascii_arena(String *dest, StringView src, Arena *arena)
+{
+    return string_copy_case(dest, src, 'a', 'z', arena);
+}
+
+ArenaError string_copy_upper_ascii_malloc(String *dest, StringView src)
+{
+    return string_copy_upper_ascii_arena(dest, src, NULL);
+}
+
+ArenaError string_copy_transform_bytes_arena(String *dest, StringView src, const unsigned char table[256], Arena *arena)
+{
+    ArenaError grow_result = string_copy_prepare(dest, src, arena);
+    if (grow_result != ARENA_SUCCESS) {
+        return grow_result;
+    }
+    table_map((unsigned char *)dest->data, (const unsigned char *)src.ptr, src.len, table);
+    string_copy_finish(dest, src.len);
+    return ARENA_SUCCESS;
+}
+
+ArenaError string_copy_transform_bytes_malloc(String *dest, StringView src, const unsigned char table[256])
+{
+    return string_copy_transform_bytes_arena(dest, src, table, NULL);
+}
@@ -0,0 +1,108 @@
+// Comparisons of Strings and case-insensitive comparisons of views.
+//
+// Exact comparisons use memcmp, which the C library already vectorizes. Case-insensitive
+// comparisons fold 16 bytes at a time with SSE2: bytes in 'A'..'Z' get the 0x20 bit set.
+
+#include "c_string.h"
+#include "c_string_internal.h"
+#include "c_string_simd.h"
+#include <string.h>
+
+bool string_equals(const String *a, const String *b)
+{
+    if (a->length != b->length) {
+        return false;
+    }
+    // Both hashes are known and differ, the contents can not be equal
+    if (a->hash != 0 && b->hash != 0 && a->hash != b->hash) {
+        return false;
+    }
+    return a->data == b->data || memcmp(a->data, b->data, a->length) == 0;
+}
+
+int string_compare(const String *a, const String *b)
+{
+    return string_view_compare(string_view_from_string(a), string_view_from_string(b));
+}
+
+bool string_starts_with(const String *string, StringView prefix)
+{
+    return string_view_starts_with(string_view_from_string(string), prefix);
+}
+
+bool string_ends_with(const String *string, StringView suffix)
+{
+    return string_view_ends_with(string_view_from_string(string), suffix);
+}
+
+#ifdef C_STRING_HAVE_SSE2
+static inline __m128i fold_sse2(__m128i bytes)
+{
+    __m128i upper = cs_byte_range_sse2(bytes, 'A', 'Z');
+    return _mm_or_si128(bytes, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+#endif
+
+// Index of the first byte where a and b differ after folding, or length if there is none
+static size_t mismatch_ignore_case(const unsigned char *a, const unsigned char *b, size_t length)
+{
+    size_t i = 0;
+
+#ifdef C_STRING_HAVE_SSE2
+    for (; i + 16 <= length; i += 16) {
+        __m128i fa = fold_sse2(_mm_loadu_si128((const __m128i *)(a + i)));
+        __m128i fb = fold_sse2(_mm_loadu_si128((const __m128i *)(b + i)));
+        uint32_t equal = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(fa, fb));
+        if (equal != 0xffff) {
+            return i + cs_ctz32(~equal & 0xffff);
+        }
+    }
+#endif
+
+    for (; i < length; i++) {
+        if (cs_ascii_lower(a[i]) != cs_ascii_lower(b[i])) {
+            return i;
+        }
+    }
+    return length;
+}
+
+bool string_view_equals_ignore_case(StringView a, StringView b)
+{
+    if (a.len != b.len) {
+        return false;
+    }
+    return a.ptr == b.ptr ||
+           mismatch_ignore_case((const unsigned char *)a.ptr, (const unsigned char *)b.ptr, a.len) == a.len;
+}
+
+int string_view_compare_ignore_case(StringView a, StringView b)
+{
+    size_t common = a.len < b.len ? a.len : b.len;
+    size_t index = mismatch_ignore_case((const unsigned char *)a.ptr, (const unsigned char *)b.ptr, common);
+    if (index < common) {
+        return (int)cs_ascii_lower((unsigned char)a.ptr[index]) - (int)cs_ascii_lower((unsigned char)b.ptr[index]);
+    }
+    return (a.len > b.len) - (a.len < b.len);
+}
+
+bool string_view_starts_with_ignore_case(StringView view, StringView prefix)
+{
+    return prefix.len <= view.len && string_view_equals_ignore_case(string_view_slice(view, 0, prefix.len), prefix);
+}
+
+bool string_view_ends_with_ignore_case(StringView view, StringView suffix)
+{
+    return suffix.len <= view.len &&
+           string_view_equals_ignore_case(string_view_slice(view, view.len - suffix.len, suffix.len), suffix);
+}
+
+bool string_equals_ignore_case(const String *a, const String *b)
+{
+    return string_view_equals_ignore_case(string_view_from_string(a), string_view_from_string(b));
+}
+
+int string_compare_ignore_case(const String *a, const String *b)
+{
+    return string_view_compare_ignore_case(string_view_from_string(a), string_view_from_string(b));
+}
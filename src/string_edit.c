@@ -0,0 +1,194 @@
+#include "c_string.h"
+#include "c_string_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Sources that point into the string being edited are copied here first, larger ones go to the heap
+#define STRING_EDIT_STACK_COPY 256
+
+typedef struct
+{
+    char stack[STRING_EDIT_STACK_COPY];
+    char *heap;
+} StringEditCopy;
+
+// Returns a view of src that stays valid while dest is rewritten. Only sources inside dest are copied.
+static bool string_edit_detach(const String *dest, StringView *src, StringEditCopy *copy)
+{
+    size_t offset;
+    if (src->len == 0 || !string_contains_pointer(dest, src->ptr, &offset)) {
+        return true;
+    }
+
+    char *buffer = copy->stack;
+    if (src->len > sizeof(copy->stack)) {
+        buffer = copy->heap = malloc(src->len);
+        if (buffer == NULL) {
+            return false;
+        }
+    }
+    memcpy(buffer, src->ptr, src->len);
+    src->ptr = buffer;
+    return true;
+}
+
+// Replaces length bytes at pos with src. pos and length must already be clamped.
+static ArenaError string_splice(String *dest, size_t pos, size_t length, StringView src, Arena *arena)
+{
+    StringEditCopy copy = { .heap = NULL };
+    if (!string_edit_detach(dest, &src, &copy)) {
+        return ARENA_ERROR_ALLOCATION_FAILED;
+    }
+
+    size_t new_length = dest->length - length + src.len;
+    ArenaError grow_result = string_grow_arena(dest, new_length + 1, arena);
+    if (grow_result != ARENA_SUCCESS) {
+        free(copy.heap);
+        return grow_result;
+    }
+
+    // Move the tail including the null terminator, then fill the gap
+    size_t tail = dest->length - pos - length;
+    memmove(dest->data + pos + src.len, dest->data + pos + length, tail + 1);
+    if (src.len > 0) {
+        memcpy(dest->data + pos, src.ptr, src.len);
+    }
+    dest->length = new_length;
+    dest->hash = 0;
+
+    free(copy.heap);
+    return ARENA_SUCCESS;
+}
+
+ArenaError string_insert_arena(String *dest, size_t pos, const char *src, size_t src_len, Arena *arena)
+{
+    if (pos > dest->length) {
+        pos = dest->length;
+    }
+    return string_splice(dest, pos, 0, string_view_from_bytes(src, src_len), arena);
+}
+
+ArenaError string_insert_malloc(String *dest, size_t pos, const char *src, size_t src_len)
+{
+    return string_insert_arena(dest, pos, src, src_len, NULL);
+}
+
+void string_erase(String *string, size_t pos, size_t length)
+{
+    if (pos >= string->length) {
+        return;
+    }
+    if (length > string->length - pos) {
+        length = string->length - pos;
+    }
+
+    // Shrinking never allocates, the tail is moved down together with the null terminator
+    memmove(string->data + pos, string->data + pos + length, string->length - pos - length + 1);
+    string->length -= length;
+    string->hash = 0;
+}
+
+ArenaError string_replace_range_arena(String *dest, size_t pos, size_t length, const char *src, size_t src_len, Arena *arena)
+{
+    if (pos > dest->length) {
+        pos = dest->length;
+    }
+    if (length > dest->length - pos) {
+        length = dest->length - pos;
+    }
+    return string_splice(dest, pos, length, string_view_from_bytes(src, src_len), arena);
+}
+
+ArenaError string_replace_range_malloc(String *dest, size_t pos, size_t length, const char *src, size_t src_len)
+{
+    return string_replace_range_arena(dest, pos, length, src, src_len, NULL);
+}
+
+// Copies text from the range starting at read to write, replacing every match of needle.
+// write must never be ahead of read, so the rewrite can happen inside a single buffer.
+static size_t string_replace_forward(char *write, const char *read, size_t read_len, StringView needle, StringView replacement)
+{
+    StringView rest = string_view_from_bytes(read, read_len);
+    char *out = write;
+    size_t pos = 0;
+
+    for (;;) {
+        size_t match = string_view_find(rest, needle, pos);
+        size_t end = match == STRING_NPOS ? rest.len : match;
+
+        memmove(out, rest.ptr + pos, end - pos);
+        out += end - pos;
+        if (match == STRING_NPOS) {
+            break;
+        }
+
+        if (replacement.len > 0) {
+            memcpy(out, replacement.ptr, replacement.len);
+            out += replacement.len;
+        }
+        pos = match + needle.len;
+    }
+    return (size_t)(out - write);
+}
+
+// Rewrites dest once count matches of needle are known. needle and replacement must not point into dest.
+static ArenaError string_replace_counted(String *dest, StringView needle, StringView replacement, size_t count, Arena *arena)
+{
+    size_t old_length = dest->length;
+    if (replacement.len <= needle.len) {
+        // The result is not longer, rewrite front to back in place
+        dest->length = string_replace_forward(dest->data, dest->data, old_length, needle, replacement);
+    } else {
+        size_t new_length = old_length + count * (replacement.len - needle.len);
+        ArenaError grow_result = string_grow_arena(dest, new_length + 1, arena);
+        if (grow_result != ARENA_SUCCESS) {
+            return grow_result;
+        }
+
+        // Move the text to the end of the buffer and rewrite it front to back. Before the k-th match
+        // the output is ahead by k * (replacement.len - needle.len) bytes, the input started
+        // count times that far ahead, so no unread byte is ever overwritten. Unlike a back to front
+        // rewrite this finds exactly the same matches as the counting pass.
+        size_t shift = new_length - old_length;
+        memmove(dest->data + shift, dest->data, old_length);
+        dest->length = string_replace_forward(dest->data, dest->data + shift, old_length, needle, replacement);
+    }
+
+    dest->data[dest->length] = '\0';
+    dest->hash = 0;
+    return ARENA_SUCCESS;
+}
+
+ArenaError string_replace_all_arena(String *dest, StringView needle, StringView replacement, Arena *arena)
+{
+    if (needle.len == 0 || needle.len > dest->length) {
+        return ARENA_SUCCESS;
+    }
+
+    // Count the matches first, so the string grows at most once
+    StringView haystack = string_view_from_string(dest);
+    size_t count = 0;
+    for (size_t pos = string_view_find(haystack, needle, 0); pos != STRING_NPOS;
+         pos = string_view_find(haystack, needle, pos + needle.len)) {
+        count++;
+    }
+    if (count == 0) {
+        return ARENA_SUCCESS;
+    }
+
+    StringEditCopy needle_copy = { .heap = NULL }, replacement_copy = { .heap = NULL };
+    ArenaError result = ARENA_ERROR_ALLOCATION_FAILED;
+    if (string_edit_detach(dest, &needle, &needle_copy) &&
+        string_edit_detach(dest, &replacement, &replacement_copy)) {
+        result = string_replace_counted(dest, needle, replacement, count, arena);
+    }
+
+    free(needle_copy.heap);
+    free(replacement_copy.heap);
+    return result;
+}
+
+ArenaError string_replace_all_malloc(String *dest, StringView needle, StringView replacement)
+{
+    return string_replace_all_arena(dest, needle, replacement, NULL);
+}
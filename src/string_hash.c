@@ -0,0 +1,110 @@
+#include "c_string.h"
+#include "c_string_internal.h"
+#include <string.h>
+
+// Hashing in the style of wyhash (final version 4, public domain). Reads are done in the native
+// byte order, hashes are only meant to be compared within one process.
+
+static const uint64_t string_hash_secret[4] = {
+    UINT64_C(0x2d358dccaa6c78a5),
+    UINT64_C(0x8bb84b93962eacc9),
+    UINT64_C(0x4b33a62ed433d4a3),
+    UINT64_C(0x4d5a2da51de1aa47),
+};
+
+// Multiplies a and b and folds the 128 bit product into 64 bits
+static inline uint64_t string_hash_mix(uint64_t a, uint64_t b)
+{
+    uint64_t high;
+    uint64_t low = cs_mul128(a, b, &high);
+    return low ^ high;
+}
+
+static inline uint64_t string_hash_read64(const unsigned char *p)
+{
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline uint64_t string_hash_read32(const unsigned char *p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+// Packs 1 to 3 bytes, every byte of the input takes part
+static inline uint64_t string_hash_read_small(const unsigned char *p, size_t length)
+{
+    return ((uint64_t)p[0] << 16) | ((uint64_t)p[length >> 1] << 8) | p[length - 1];
+}
+
+uint64_t string_view_hash(StringView view)
+{
+    const unsigned char *p = (const unsigned char *)view.ptr;
+    size_t length = view.len;
+    const uint64_t *secret = string_hash_secret;
+
+    uint64_t seed = string_hash_mix(secret[0], secret[1]);
+    uint64_t a, b;
+
+    if (length <= 16) {
+        if (length >= 4) {
+            // Two possibly overlapping pairs of 4 byte reads cover 4 to 16 bytes
+            size_t shift = (length >> 3) << 2;
+            a = (string_hash_read32(p) << 32) | string_hash_read32(p + shift);
+            b = (string_hash_read32(p + length - 4) << 32) | string_hash_read32(p + length - 4 - shift);
+        } else if (length > 0) {
+            a = string_hash_read_small(p, length);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t remaining = length;
+        if (remaining > 48) {
+            // Three independent lanes keep several multiplications in flight
+            uint64_t seed1 = seed, seed2 = seed;
+            do {
+                seed = string_hash_mix(string_hash_read64(p) ^ secret[1], string_hash_read64(p + 8) ^ seed);
+                seed1 = string_hash_mix(string_hash_read64(p + 16) ^ secret[2], string_hash_read64(p + 24) ^ seed1);
+                seed2 = string_hash_mix(string_hash_read64(p + 32) ^ secret[3], string_hash_read64(p + 40) ^ seed2);
+                p += 48;
+                remaining -= 48;
+            } while (remaining > 48);
+            seed ^= seed1 ^ seed2;
+        }
+        while (remaining > 16) {
+            seed = string_hash_mix(string_hash_read64(p) ^ secret[1], string_hash_read64(p + 8) ^ seed);
+            p += 16;
+            remaining -= 16;
+        }
+        // The last 16 bytes, overlapping already mixed bytes if needed
+        a = string_hash_read64(p + remaining - 16);
+        b = string_hash_read64(p + remaining - 8);
+    }
+
+    a ^= secret[1];
+    b ^= seed;
+    uint64_t high;
+    a = cs_mul128(a, b, &high);
+    b = high;
+    uint64_t hash = string_hash_mix(a ^ secret[0] ^ (uint64_t)length, b ^ secret[1]);
+
+    // 0 marks a missing cached hash in String
+    return hash ? hash : 1;
+}
+
+uint64_t string_hash(String *string)
+{
+    if (string->hash == 0) {
+        string->hash = string_view_hash(string_view_from_string(string));
+    }
+    return string->hash;
+}
+
+void string_invalidate_hash(String *string)
+{
+    string->hash = 0;
+}
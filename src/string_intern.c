@@ -0,0 +1,203 @@
+#include "string_intern.h"
+#include "c_string_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define STRING_INTERN_SHARD_BITS 4
+#define STRING_INTERN_MIN_SLOTS 64
+
+// Ids keep the shard in their low bits, the index within the shard above them
+#define STRING_INTERN_MAX_INDEX (STRING_INTERN_INVALID_ID >> STRING_INTERN_SHARD_BITS)
+
+_Static_assert((1 << STRING_INTERN_SHARD_BITS) == STRING_INTERN_SHARDS, "shard bits do not match the shard count");
+
+// The shard is chosen by the high bits, the slot by the low bits, so both stay independent
+static size_t string_intern_shard_index(uint64_t hash)
+{
+    return (size_t)(hash >> (64 - STRING_INTERN_SHARD_BITS));
+}
+
+ArenaError string_intern_pool_init(StringInternPool *pool)
+{
+    for (size_t i = 0; i < STRING_INTERN_SHARDS; i++) {
+        StringInternShard *shard = &pool->shards[i];
+        if (mtx_init(&shard->lock, mtx_plain) != thrd_success) {
+            while (i-- > 0) {
+                mtx_destroy(&pool->shards[i].lock);
+            }
+            return ARENA_ERROR_ALLOCATION_FAILED;
+        }
+        shard->slots = NULL;
+        shard->slot_count = 0;
+        shard->strings = NULL;
+        shard->count = 0;
+        shard->capacity = 0;
+        chunk_arena_init(&shard->arena, 0);
+    }
+    return ARENA_SUCCESS;
+}
+
+void string_intern_pool_free(StringInternPool *pool)
+{
+    for (size_t i = 0; i < STRING_INTERN_SHARDS; i++) {
+        StringInternShard *shard = &pool->shards[i];
+        free(shard->slots);
+        free(shard->strings);
+        chunk_arena_free(&shard->arena);
+        mtx_destroy(&shard->lock);
+    }
+}
+
+// Returns the slot holding text, or the empty slot where it would be inserted. Needs the shard lock.
+static StringInternSlot *string_intern_probe(StringInternShard *shard, StringView text, uint32_t hash)
+{
+    size_t mask = shard->slot_count - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        StringInternSlot *slot = &shard->slots[i];
+        if (slot->index == 0) {
+            return slot;
+        }
+        if (slot->hash == hash) {
+            const String *string = shard->strings[slot->index - 1];
+            if (string->length == text.len && memcmp(string->data, text.ptr, text.len) == 0) {
+                return slot;
+            }
+        }
+    }
+}
+
+// Doubles the index of a shard. The stored hashes are enough to rehash, strings are not touched.
+static bool string_intern_grow_slots(StringInternShard *shard)
+{
+    size_t slot_count = shard->slot_count ? shard->slot_count * 2 : STRING_INTERN_MIN_SLOTS;
+    StringInternSlot *slots = calloc(slot_count, sizeof(StringInternSlot));
+    if (slots == NULL) {
+        return false;
+    }
+
+    size_t mask = slot_count - 1;
+    for (size_t i = 0; i < shard->slot_count; i++) {
+        StringInternSlot slot = shard->slots[i];
+        if (slot.index == 0) {
+            continue;
+        }
+        size_t j = slot.hash & mask;
+        while (slots[j].index != 0) {
+            j = (j + 1) & mask;
+        }
+        slots[j] = slot;
+    }
+
+    free(shard->slots);
+    shard->slots = slots;
+    shard->slot_count = slot_count;
+    return true;
+}
+
+static StringInternId string_intern_make_id(size_t shard_index, size_t index)
+{
+    return (StringInternId)((index << STRING_INTERN_SHARD_BITS) | shard_index);
+}
+
+// Adds a new string to a shard. Needs the shard lock.
+static const String *string_intern_insert(StringInternShard *shard, StringView text, uint64_t hash, size_t *index)
+{
+    if (shard->count >= STRING_INTERN_MAX_INDEX) {
+        return NULL;
+    }
+
+    // Keep the load factor at or below 3/4
+    if ((shard->count + 1) * 4 > shard->slot_count * 3 && !string_intern_grow_slots(shard)) {
+        return NULL;
+    }
+
+    if (shard->count == shard->capacity) {
+        size_t capacity = shard->capacity ? shard->capacity * 2 : STRING_INTERN_MIN_SLOTS;
+        const String **strings = realloc(shard->strings, capacity * sizeof(*strings));
+        if (strings == NULL) {
+            return NULL;
+        }
+        shard->strings = strings;
+        shard->capacity = capacity;
+    }
+
+    String *string = string_new_bytes_chunk_arena(text.ptr, text.len, &shard->arena);
+    if (string == NULL) {
+        return NULL;
+    }
+    string->hash = hash; // Interned strings never change, their hash stays cached
+
+    StringInternSlot *slot = string_intern_probe(shard, text, (uint32_t)hash);
+    *index = shard->count;
+    shard->strings[shard->count++] = string;
+    slot->hash = (uint32_t)hash;
+    slot->index = (uint32_t)shard->count;
+    return string;
+}
+
+// Shared implementation of string_intern and string_intern_find
+static const String *string_intern_get(StringInternPool *pool, StringView text, StringInternId *id, bool insert)
+{
+    uint64_t hash = string_view_hash(text);
+    size_t shard_index = string_intern_shard_index(hash);
+    StringInternShard *shard = &pool->shards[shard_index];
+
+    const String *string = NULL;
+    size_t index = 0;
+
+    mtx_lock(&shard->lock);
+    if (shard->slot_count > 0) {
+        StringInternSlot *slot = string_intern_probe(shard, text, (uint32_t)hash);
+        if (slot->index != 0) {
+            index = slot->index - 1;
+            string = shard->strings[index];
+        }
+    }
+    if (string == NULL && insert) {
+        string = string_intern_insert(shard, text, hash, &index);
+    }
+    mtx_unlock(&shard->lock);
+
+    if (id) {
+        *id = string ? string_intern_make_id(shard_index, index) : STRING_INTERN_INVALID_ID;
+    }
+    return string;
+}
+
+const String *string_intern(StringInternPool *pool, StringView text, StringInternId *id)
+{
+    return string_intern_get(pool, text, id, true);
+}
+
+const String *string_intern_find(StringInternPool *pool, StringView text, StringInternId *id)
+{
+    return string_intern_get(pool, text, id, false);
+}
+
+const String *string_intern_lookup(StringInternPool *pool, StringInternId id)
+{
+    if (id == STRING_INTERN_INVALID_ID) {
+        return NULL;
+    }
+
+    StringInternShard *shard = &pool->shards[id & (STRING_INTERN_SHARDS - 1)];
+    size_t index = id >> STRING_INTERN_SHARD_BITS;
+
+    // The strings array may be reallocated by a concurrent insert
+    mtx_lock(&shard->lock);
+    const String *string = index < shard->count ? shard->strings[index] : NULL;
+    mtx_unlock(&shard->lock);
+    return string;
+}
+
+size_t string_intern_count(StringInternPool *pool)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < STRING_INTERN_SHARDS; i++) {
+        StringInternShard *shard = &pool->shards[i];
+        mtx_lock(&shard->lock);
+        count += shard->count;
+        mtx_unlock(&shard->lock);
+    }
+    return count;
+}
@@ -0,0 +1,331 @@
+#include "string_map.h"
+#include "c_string_internal.h"
+#include "c_string_simd.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Control bytes: full slots hold the low 7 bits of the hash, free slots have the high bit set
+#define STRING_MAP_EMPTY ((int8_t)-128)
+#define STRING_MAP_DELETED ((int8_t)-2)
+
+#define STRING_MAP_GROUP_WIDTH 16
+
+// Bit i of a mask refers to slot i of a group
+typedef uint32_t StringMapMask;
+
+static inline StringMapMask string_map_match(const int8_t *group, int8_t tag)
+{
+#ifdef C_STRING_HAVE_SSE2
+    __m128i control = _mm_loadu_si128((const __m128i *)group);
+    return (StringMapMask)_mm_movemask_epi8(_mm_cmpeq_epi8(control, _mm_set1_epi8(tag)));
+#else
+    StringMapMask mask = 0;
+    for (unsigned i = 0; i < STRING_MAP_GROUP_WIDTH; i++) {
+        mask |= (StringMapMask)(group[i] == tag) << i;
+    }
+    return mask;
+#endif
+}
+
+// Slots that are empty or deleted, i.e. whose control byte has the high bit set
+static inline StringMapMask string_map_match_free(const int8_t *group)
+{
+#ifdef C_STRING_HAVE_SSE2
+    return (StringMapMask)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)group));
+#else
+    StringMapMask mask = 0;
+    for (unsigned i = 0; i < STRING_MAP_GROUP_WIDTH; i++) {
+        mask |= (StringMapMask)(group[i] < 0) << i;
+    }
+    return mask;
+#endif
+}
+
+static inline size_t string_map_h1(uint64_t hash)
+{
+    return (size_t)(hash >> 7);
+}
+
+static inline int8_t string_map_h2(uint64_t hash)
+{
+    return (int8_t)(hash & 0x7f);
+}
+
+// Sets a control byte, slots of the first group are mirrored behind the table so that a group
+// can be loaded at any slot without wrapping around
+static inline void string_map_set_control(StringMap *map, size_t index, int8_t control)
+{
+    map->control[index] = control;
+    if (index < STRING_MAP_GROUP_WIDTH) {
+        map->control[map->capacity + index] = control;
+    }
+}
+
+// Most inserts fit into a table that is 7/8 full
+static size_t string_map_max_load(size_t capacity)
+{
+    return capacity - capacity / 8;
+}
+
+void string_map_init(StringMap *map)
+{
+    map->entries = NULL;
+    map->control = NULL;
+    map->capacity = 0;
+    map->size = 0;
+    map->growth_left = 0;
+    chunk_arena_init(&map->keys, 0);
+}
+
+void string_map_free(StringMap *map)
+{
+    // Entries and control bytes share one allocation
+    free(map->entries);
+    chunk_arena_free(&map->keys);
+    string_map_init(map);
+}
+
+size_t string_map_size(const StringMap *map)
+{
+    return map->size;
+}
+
+// Returns the slot of key, or STRING_NPOS. Probing visits groups at triangular offsets, which
+// reaches every group because the capacity is a power of two.
+static size_t string_map_lookup(const StringMap *map, StringView key, uint64_t hash)
+{
+    if (map->capacity == 0) {
+        return STRING_NPOS;
+    }
+
+    size_t mask = map->capacity - 1;
+    size_t pos = string_map_h1(hash) & mask;
+    int8_t tag = string_map_h2(hash);
+
+    for (size_t step = STRING_MAP_GROUP_WIDTH;; step += STRING_MAP_GROUP_WIDTH) {
+        const int8_t *group = map->control + pos;
+        for (StringMapMask match = string_map_match(group, tag); match; match &= match - 1) {
+            size_t index = (pos + cs_ctz32(match)) & mask;
+            const String *candidate = map->entries[index].key;
+            if (candidate->hash == hash && candidate->length == key.len &&
+                (key.len == 0 || memcmp(candidate->data, key.ptr, key.len) == 0)) {
+                return index;
+            }
+        }
+        // An empty slot ends every probe sequence that could contain the key
+        if (string_map_match(group, STRING_MAP_EMPTY)) {
+            return STRING_NPOS;
+        }
+        pos = (pos + step) & mask;
+    }
+}
+
+// Returns the first empty or deleted slot on the probe sequence of hash. The table must have one.
+static size_t string_map_find_free(const StringMap *map, uint64_t hash)
+{
+    size_t mask = map->capacity - 1;
+    size_t pos = string_map_h1(hash) & mask;
+
+    for (size_t step = STRING_MAP_GROUP_WIDTH;; step += STRING_MAP_GROUP_WIDTH) {
+        StringMapMask free_slots = string_map_match_free(map->control + pos);
+        if (free_slots) {
+            return (pos + cs_ctz32(free_slots)) & mask;
+        }
+        pos = (pos + step) & mask;
+    }
+}
+
+// Moves all entries into a new table of capacity slots, dropping deleted slots on the way.
+// Keys keep their cached hash, so no key is hashed again.
+static ArenaError string_map_rehash(StringMap *map, size_t capacity)
+{
+    StringMapEntry *entries = malloc(capacity * sizeof(StringMapEntry) + capacity + STRING_MAP_GROUP_WIDTH);
+    if (entries == NULL) {
+        return ARENA_ERROR_ALLOCATION_FAILED;
+    }
+
+    StringMap grown = *map;
+    grown.entries = entries;
+    grown.control = (int8_t *)(entries + capacity);
+    grown.capacity = capacity;
+    memset(grown.control, STRING_MAP_EMPTY, capacity + STRING_MAP_GROUP_WIDTH);
+
+    for (size_t i = 0; i < map->capacity; i++) {
+        if (map->control[i] < 0) {
+            continue;
+        }
+        uint64_t hash = map->entries[i].key->hash;
+        size_t index = string_map_find_free(&grown, hash);
+        string_map_set_control(&grown, index, string_map_h2(hash));
+        grown.entries[index] = map->entries[i];
+    }
+
+    free(map->entries);
+    map->entries = grown.entries;
+    map->control = grown.control;
+    map->capacity = capacity;
+    map->growth_left = string_map_max_load(capacity) - map->size;
+    return ARENA_SUCCESS;
+}
+
+// Smallest power of two capacity that holds count keys
+static size_t string_map_capacity_for(size_t count)
+{
+    size_t capacity = STRING_MAP_GROUP_WIDTH;
+    while (string_map_max_load(capacity) < count) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+ArenaError string_map_reserve(StringMap *map, size_t count)
+{
+    if (count <= map->size + map->growth_left) {
+        return ARENA_SUCCESS;
+    }
+    return string_map_rehash(map, string_map_capacity_for(count));
+}
+
+// Makes sure one more key can go into an empty slot
+static ArenaError string_map_prepare_insert(StringMap *map)
+{
+    if (map->growth_left > 0) {
+        return ARENA_SUCCESS;
+    }
+
+    // Mostly deleted slots: rebuild at the same size, otherwise double
+    size_t capacity = map->capacity;
+    if (capacity == 0 || map->size >= string_map_max_load(capacity) / 2) {
+        capacity = string_map_capacity_for(map->size + 1);
+        if (capacity <= map->capacity) {
+            capacity = map->capacity * 2;
+        }
+    }
+    return string_map_rehash(map, capacity);
+}
+
+static void **string_map_emplace_hashed(StringMap *map, StringView key, uint64_t hash, bool *inserted)
+{
+    size_t index = string_map_lookup(map, key, hash);
+    if (index != STRING_NPOS) {
+        if (inserted) {
+            *inserted = false;
+        }
+        return &map->entries[index].value;
+    }
+
+    if (string_map_prepare_insert(map) != ARENA_SUCCESS) {
+        return NULL;
+    }
+
+    String *copy = string_new_bytes_chunk_arena(key.ptr, key.len, &map->keys);
+    if (copy == NULL) {
+        return NULL;
+    }
+    copy->hash = hash;
+
+    index = string_map_find_free(map, hash);
+    if (map->control[index] == STRING_MAP_EMPTY) {
+        map->growth_left--;
+    }
+    string_map_set_control(map, index, string_map_h2(hash));
+    map->entries[index].key = copy;
+    map->entries[index].value = NULL;
+    map->size++;
+
+    if (inserted) {
+        *inserted = true;
+    }
+    return &map->entries[index].value;
+}
+
+void **string_map_emplace(StringMap *map, StringView key, bool *inserted)
+{
+    return string_map_emplace_hashed(map, key, string_view_hash(key), inserted);
+}
+
+void **string_map_emplace_string(StringMap *map, String *key, bool *inserted)
+{
+    return string_map_emplace_hashed(map, string_view_from_string(key), string_hash(key), inserted);
+}
+
+ArenaError string_map_upsert(StringMap *map, StringView key, void *value)
+{
+    void **slot = string_map_emplace(map, key, NULL);
+    if (slot == NULL) {
+        return ARENA_ERROR_ALLOCATION_FAILED;
+    }
+    *slot = value;
+    return ARENA_SUCCESS;
+}
+
+ArenaError string_map_insert_bulk(StringMap *map, const StringView *keys, void *const *values, size_t count)
+{
+    ArenaError reserve_result = string_map_reserve(map, map->size + count);
+    if (reserve_result != ARENA_SUCCESS) {
+        return reserve_result;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        bool inserted;
+        void **slot = string_map_emplace(map, keys[i], &inserted);
+        if (slot == NULL) {
+            return ARENA_ERROR_ALLOCATION_FAILED;
+        }
+        if (inserted) {
+            *slot = values ? values[i] : NULL;
+        }
+    }
+    return ARENA_SUCCESS;
+}
+
+void **string_map_find(const StringMap *map, StringView key)
+{
+    size_t index = string_map_lookup(map, key, string_view_hash(key));
+    return index == STRING_NPOS ? NULL : &map->entries[index].value;
+}
+
+void **string_map_find_string(const StringMap *map, String *key)
+{
+    size_t index = string_map_lookup(map, string_view_from_string(key), string_hash(key));
+    return index == STRING_NPOS ? NULL : &map->entries[index].value;
+}
+
+void **string_map_find_bytes(const StringMap *map, const char *key, size_t key_len)
+{
+    return string_map_find(map, string_view_from_bytes(key, key_len));
+}
+
+void *string_map_get(const StringMap *map, StringView key)
+{
+    void **slot = string_map_find(map, key);
+    return slot ? *slot : NULL;
+}
+
+bool string_map_remove(StringMap *map, StringView key, void **value)
+{
+    size_t index = string_map_lookup(map, key, string_view_hash(key));
+    if (index == STRING_NPOS) {
+        return false;
+    }
+
+    if (value) {
+        *value = map->entries[index].value;
+    }
+
+    // Leave a tombstone, probe sequences of other keys may pass through this slot
+    string_map_set_control(map, index, STRING_MAP_DELETED);
+    map->size--;
+    return true;
+}
+
+const StringMapEntry *string_map_next(const StringMap *map, size_t *cursor)
+{
+    while (*cursor < map->capacity) {
+        size_t index = (*cursor)++;
+        if (map->control[index] >= 0) {
+            return &map->entries[index];
+        }
+    }
+    return NULL;
+}
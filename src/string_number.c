@@ -0,0 +1,1031 @@
+// Appending numbers to `String` without going through printf, and parsing them back.
+//
+// Integers are written two digits at a time from a lookup table. Doubles use the Grisu2 algorithm
+// (Florian Loitsch, "Printing Floating-Point Numbers Quickly and Accurately with Integers"), which
+// produces the shortest digit sequence that round-trips in almost all cases and a correct, at most
+// slightly longer, sequence otherwise. The Grisu2 code (DiyFp, digit generation and the decimal
+// layout) is adapted from the dtoa of RapidJSON, Copyright (C) 2015 THL A29 Limited, a Tencent
+// company, and Milo Yip, licensed under the MIT License (https://opensource.org/licenses/MIT).
+//
+// Parsing works on explicit lengths and ignores the locale. Integers are converted 8 digits at a
+// time with SWAR arithmetic. Doubles take the Clinger fast path when the value is exactly
+// representable, otherwise the Eisel-Lemire algorithm, and only fall back to an exact big integer
+// comparison for inputs with more than 19 significant digits whose rounding can not be decided.
+
+#include "c_string.h"
+#include "c_string_internal.h"
+#include "c_string_pow5.h"
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+// Longest possible output of the formatting helpers below
+#define NUMBER_BUFFER_SIZE 32
+
+static const char digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static unsigned count_digits_u64(uint64_t value)
+{
+    unsigned digits = 1;
+    for (;;) {
+        if (value < 10) return digits;
+        if (value < 100) return digits + 1;
+        if (value < 1000) return digits + 2;
+        if (value < 10000) return digits + 3;
+        value /= 10000;
+        digits += 4;
+    }
+}
+
+// Writes the decimal digits of value to out and returns their count
+static size_t format_u64(char *out, uint64_t value)
+{
+    size_t length = count_digits_u64(value);
+    char *p = out + length;
+
+    while (value >= 100) {
+        unsigned pair = (unsigned)(value % 100) * 2;
+        value /= 100;
+        *--p = digit_pairs[pair + 1];
+        *--p = digit_pairs[pair];
+    }
+    if (value >= 10) {
+        unsigned pair = (unsigned)value * 2;
+        *--p = digit_pairs[pair + 1];
+        *--p = digit_pairs[pair];
+    } else {
+        *--p = (char)('0' + value);
+    }
+    return length;
+}
+
+static size_t format_i64(char *out, int64_t value)
+{
+    if (value < 0) {
+        *out = '-';
+        // Negate in unsigned arithmetic, so INT64_MIN does not overflow
+        return 1 + format_u64(out + 1, 0 - (uint64_t)value);
+    }
+    return format_u64(out, (uint64_t)value);
+}
+
+static size_t format_hex(char *out, uint64_t value)
+{
+    static const char hex_digits[] = "0123456789abcdef";
+    size_t length = 1;
+    while (length < 16 && (value >> (4 * length)) != 0) {
+        length++;
+    }
+    for (size_t i = length; i > 0; i--) {
+        out[i - 1] = hex_digits[value & 0xF];
+        value >>= 4;
+    }
+    return length;
+}
+
+// ---- Grisu2 ----
+
+typedef struct
+{
+    uint64_t f;
+    int e;
+} DiyFp;
+
+#define DP_SIGNIFICAND_SIZE 52
+#define DP_EXPONENT_BIAS (0x3FF + DP_SIGNIFICAND_SIZE)
+#define DP_MIN_EXPONENT (-DP_EXPONENT_BIAS)
+#define DP_EXPONENT_MASK UINT64_C(0x7FF0000000000000)
+#define DP_SIGNIFICAND_MASK UINT64_C(0x000FFFFFFFFFFFFF)
+#define DP_HIDDEN_BIT UINT64_C(0x0010000000000000)
+
+// Normalized 64 bit approximations of 10^k for k = -348, -340, ..., 340
+static const uint64_t cached_powers_f[] = {
+    UINT64_C(0xfa8fd5a0081c0288), UINT64_C(0xbaaee17fa23ebf76), UINT64_C(0x8b16fb203055ac76),
+    UINT64_C(0xcf42894a5dce35ea), UINT64_C(0x9a6bb0aa55653b2d), UINT64_C(0xe61acf033d1a45df),
+    UINT64_C(0xab70fe17c79ac6ca), UINT64_C(0xff77b1fcbebcdc4f), UINT64_C(0xbe5691ef416bd60c),
+    UINT64_C(0x8dd01fad907ffc3c), UINT64_C(0xd3515c2831559a83), UINT64_C(0x9d71ac8fada6c9b5),
+    UINT64_C(0xea9c227723ee8bcb), UINT64_C(0xaecc49914078536d), UINT64_C(0x823c12795db6ce57),
+    UINT64_C(0xc21094364dfb5637), UINT64_C(0x9096ea6f3848984f), UINT64_C(0xd77485cb25823ac7),
+    UINT64_C(0xa086cfcd97bf97f4), UINT64_C(0xef340a98172aace5), UINT64_C(0xb23867fb2a35b28e),
+    UINT64_C(0x84c8d4dfd2c63f3b), UINT64_C(0xc5dd44271ad3cdba), UINT64_C(0x936b9fcebb25c996),
+    UINT64_C(0xdbac6c247d62a584), UINT64_C(0xa3ab66580d5fdaf6), UINT64_C(0xf3e2f893dec3f126),
+    UINT64_C(0xb5b5ada8aaff80b8), UINT64_C(0x87625f056c7c4a8b), UINT64_C(0xc9bcff6034c13053),
+    UINT64_C(0x964e858c91ba2655), UINT64_C(0xdff9772470297ebd), UINT64_C(0xa6dfbd9fb8e5b88f),
+    UINT64_C(0xf8a95fcf88747d94), UINT64_C(0xb94470938fa89bcf), UINT64_C(0x8a08f0f8bf0f156b),
+    UINT64_C(0xcdb02555653131b6), UINT64_C(0x993fe2c6d07b7fac), UINT64_C(0xe45c10c42a2b3b06),
+    UINT64_C(0xaa242499697392d3), UINT64_C(0xfd87b5f28300ca0e), UINT64_C(0xbce5086492111aeb),
+    UINT64_C(0x8cbccc096f5088cc), UINT64_C(0xd1b71758e219652c), UINT64_C(0x9c40000000000000),
+    UINT64_C(0xe8d4a51000000000), UINT64_C(0xad78ebc5ac620000), UINT64_C(0x813f3978f8940984),
+    UINT64_C(0xc097ce7bc90715b3), UINT64_C(0x8f7e32ce7bea5c70), UINT64_C(0xd5d238a4abe98068),
+    UINT64_C(0x9f4f2726179a2245), UINT64_C(0xed63a231d4c4fb27), UINT64_C(0xb0de65388cc8ada8),
+    UINT64_C(0x83c7088e1aab65db), UINT64_C(0xc45d1df942711d9a), UINT64_C(0x924d692ca61be758),
+    UINT64_C(0xda01ee641a708dea), UINT64_C(0xa26da3999aef774a), UINT64_C(0xf209787bb47d6b85),
+    UINT64_C(0xb454e4a179dd1877), UINT64_C(0x865b86925b9bc5c2), UINT64_C(0xc83553c5c8965d3d),
+    UINT64_C(0x952ab45cfa97a0b3), UINT64_C(0xde469fbd99a05fe3), UINT64_C(0xa59bc234db398c25),
+    UINT64_C(0xf6c69a72a3989f5c), UINT64_C(0xb7dcbf5354e9bece), UINT64_C(0x88fcf317f22241e2),
+    UINT64_C(0xcc20ce9bd35c78a5), UINT64_C(0x98165af37b2153df), UINT64_C(0xe2a0b5dc971f303a),
+    UINT64_C(0xa8d9d1535ce3b396), UINT64_C(0xfb9b7cd9a4a7443c), UINT64_C(0xbb764c4ca7a44410),
+    UINT64_C(0x8bab8eefb6409c1a), UINT64_C(0xd01fef10a657842c), UINT64_C(0x9b10a4e5e9913129),
+    UINT64_C(0xe7109bfba19c0c9d), UINT64_C(0xac2820d9623bf429), UINT64_C(0x80444b5e7aa7cf85),
+    UINT64_C(0xbf21e44003acdd2d), UINT64_C(0x8e679c2f5e44ff8f), UINT64_C(0xd433179d9c8cb841),
+    UINT64_C(0x9e19db92b4e31ba9), UINT64_C(0xeb96bf6ebadf77d9), UINT64_C(0xaf87023b9bf0ee6b),
+};
+
+static const int16_t cached_powers_e[] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+    -954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+    -688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+    -422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+    -157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+    109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+    641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+    907, 933, 960, 986, 1013, 1039, 1066,
+};
+
+static DiyFp diy_fp_from_double(uint64_t bits)
+{
+    DiyFp fp;
+    int biased_e = (int)((bits & DP_EXPONENT_MASK) >> DP_SIGNIFICAND_SIZE);
+    uint64_t significand = bits & DP_SIGNIFICAND_MASK;
+    if (biased_e != 0) {
+        fp.f = significand + DP_HIDDEN_BIT;
+        fp.e = biased_e - DP_EXPONENT_BIAS;
+    } else {
+        fp.f = significand;
+        fp.e = DP_MIN_EXPONENT + 1;
+    }
+    return fp;
+}
+
+// Product of two DiyFp, rounded to 64 bits
+static DiyFp diy_fp_multiply(DiyFp x, DiyFp y)
+{
+    const uint64_t mask32 = UINT64_C(0xFFFFFFFF);
+    uint64_t a = x.f >> 32, b = x.f & mask32;
+    uint64_t c = y.f >> 32, d = y.f & mask32;
+    uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+    uint64_t tmp = (bd >> 32) + (ad & mask32) + (bc & mask32);
+    tmp += UINT64_C(1) << 31; // Round
+    DiyFp result = { ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), x.e + y.e + 64 };
+    return result;
+}
+
+static DiyFp diy_fp_normalize(DiyFp x)
+{
+    while (!(x.f & (UINT64_C(1) << 63))) {
+        x.f <<= 1;
+        x.e--;
+    }
+    return x;
+}
+
+// Computes the normalized upper and lower boundary of the rounding interval of v
+static void diy_fp_boundaries(DiyFp v, DiyFp *minus, DiyFp *plus)
+{
+    DiyFp pl = { (v.f << 1) + 1, v.e - 1 };
+    while (!(pl.f & (DP_HIDDEN_BIT << 1))) {
+        pl.f <<= 1;
+        pl.e--;
+    }
+    pl.f <<= 64 - DP_SIGNIFICAND_SIZE - 2;
+    pl.e -= 64 - DP_SIGNIFICAND_SIZE - 2;
+
+    DiyFp mi;
+    if (v.f == DP_HIDDEN_BIT) {
+        mi.f = (v.f << 2) - 1;
+        mi.e = v.e - 2;
+    } else {
+        mi.f = (v.f << 1) - 1;
+        mi.e = v.e - 1;
+    }
+    mi.f <<= mi.e - pl.e;
+    mi.e = pl.e;
+
+    *plus = pl;
+    *minus = mi;
+}
+
+// Picks a cached power c_mk = 10^-K so that e + c_mk.e + 64 lands in the range Grisu2 needs
+static DiyFp cached_power(int e, int *K)
+{
+    double dk = (-61 - e) * 0.30102999566398114 + 347; // dk must be positive
+    int k = (int)dk;
+    if (dk - k > 0.0) {
+        k++;
+    }
+
+    unsigned index = (unsigned)((k >> 3) + 1);
+    *K = -(-348 + (int)(index * 8));
+
+    DiyFp power = { cached_powers_f[index], cached_powers_e[index] };
+    return power;
+}
+
+static const uint64_t pow10_u64[] = {
+    UINT64_C(1), UINT64_C(10), UINT64_C(100), UINT64_C(1000), UINT64_C(10000), UINT64_C(100000),
+    UINT64_C(1000000), UINT64_C(10000000), UINT64_C(100000000), UINT64_C(1000000000),
+    UINT64_C(10000000000), UINT64_C(100000000000), UINT64_C(1000000000000),
+    UINT64_C(10000000000000), UINT64_C(100000000000000), UINT64_C(1000000000000000),
+    UINT64_C(10000000000000000), UINT64_C(100000000000000000), UINT64_C(1000000000000000000),
+    UINT64_C(10000000000000000000),
+};
+
+static void grisu_round(char *buffer, size_t length, uint64_t delta, uint64_t rest, uint64_t ten_kappa, uint64_t wp_w)
+{
+    while (rest < wp_w && delta - rest >= ten_kappa &&
+           (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+        buffer[length - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+static void grisu_digit_gen(DiyFp W, DiyFp Mp, uint64_t delta, char *buffer, size_t *length, int *K)
+{
+    const DiyFp one = { UINT64_C(1) << -Mp.e, Mp.e };
+    const uint64_t wp_w = Mp.f - W.f;
+    uint32_t p1 = (uint32_t)(Mp.f >> -one.e);
+    uint64_t p2 = Mp.f & (one.f - 1);
+    int kappa = (int)count_digits_u64(p1);
+    *length = 0;
+
+    while (kappa > 0) {
+        uint32_t divisor = (uint32_t)pow10_u64[kappa - 1];
+        uint32_t d = p1 / divisor;
+        p1 %= divisor;
+        if (d || *length) {
+            buffer[(*length)++] = (char)('0' + d);
+        }
+        kappa--;
+        uint64_t tmp = ((uint64_t)p1 << -one.e) + p2;
+        if (tmp <= delta) {
+            *K += kappa;
+            grisu_round(buffer, *length, delta, tmp, pow10_u64[kappa] << -one.e, wp_w);
+            return;
+        }
+    }
+
+    // kappa == 0
+    for (;;) {
+        p2 *= 10;
+        delta *= 10;
+        char d = (char)(p2 >> -one.e);
+        if (d || *length) {
+            buffer[(*length)++] = (char)('0' + d);
+        }
+        p2 &= one.f - 1;
+        kappa--;
+        if (p2 < delta) {
+            *K += kappa;
+            int index = -kappa;
+            grisu_round(buffer, *length, delta, p2, one.f, wp_w * (index < 20 ? pow10_u64[index] : 0));
+            return;
+        }
+    }
+}
+
+// Writes the shortest digits of a positive, finite double. The value is digits * 10^K.
+static size_t grisu2(uint64_t bits, char *buffer, int *K)
+{
+    DiyFp v = diy_fp_from_double(bits);
+    DiyFp w_minus, w_plus;
+    diy_fp_boundaries(v, &w_minus, &w_plus);
+
+    DiyFp c_mk = cached_power(w_plus.e, K);
+    DiyFp W = diy_fp_multiply(diy_fp_normalize(v), c_mk);
+    DiyFp Wp = diy_fp_multiply(w_plus, c_mk);
+    DiyFp Wm = diy_fp_multiply(w_minus, c_mk);
+    Wm.f++;
+    Wp.f--;
+
+    size_t length;
+    grisu_digit_gen(W, Wp, Wp.f - Wm.f, buffer, &length, K);
+    return length;
+}
+
+// Lays out the digits as decimal or exponent notation, like JavaScript's Number.prototype.toString
+static size_t format_decimal(char *out, const char *digits, size_t length, int K)
+{
+    int point = (int)length + K; // Position of the decimal point relative to the first digit
+    char *p = out;
+
+    if (point > 0 && point <= 21) {
+        if ((int)length <= point) {
+            // Integer, pad with zeros
+            memcpy(p, digits, length);
+            p += length;
+            memset(p, '0', (size_t)(point - (int)length));
+            p += point - (int)length;
+        } else {
+            memcpy(p, digits, (size_t)point);
+            p += point;
+            *p++ = '.';
+            memcpy(p, digits + point, length - (size_t)point);
+            p += length - (size_t)point;
+        }
+    } else if (point <= 0 && point > -6) {
+        // 0.000ddd
+        *p++ = '0';
+        *p++ = '.';
+        memset(p, '0', (size_t)-point);
+        p += -point;
+        memcpy(p, digits, length);
+        p += length;
+    } else {
+        // d.ddde+xx
+        *p++ = digits[0];
+        if (length > 1) {
+            *p++ = '.';
+            memcpy(p, digits + 1, length - 1);
+            p += length - 1;
+        }
+        int exponent = point - 1;
+        *p++ = 'e';
+        *p++ = exponent < 0 ? '-' : '+';
+        p += format_u64(p, (uint64_t)(exponent < 0 ? -exponent : exponent));
+    }
+
+    return (size_t)(p - out);
+}
+
+static size_t format_double(char *out, double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    char *p = out;
+    if (bits >> 63) {
+        *p++ = '-';
+        bits &= ~(UINT64_C(1) << 63);
+    }
+
+    if ((bits & DP_EXPONENT_MASK) == DP_EXPONENT_MASK) {
+        if (bits & DP_SIGNIFICAND_MASK) {
+            // NaN has no meaningful sign
+            memcpy(out, "nan", 3);
+            return 3;
+        }
+        memcpy(p, "inf", 3);
+        return (size_t)(p - out) + 3;
+    }
+
+    if (bits == 0) {
+        *p++ = '0';
+        return (size_t)(p - out);
+    }
+
+    char digits[NUMBER_BUFFER_SIZE];
+    int K = 0;
+    size_t length = grisu2(bits, digits, &K);
+    return (size_t)(p - out) + format_decimal(p, digits, length, K);
+}
+
+// Makes room for max_length more bytes with a single capacity check and returns where the
+// digits go. The caller finishes with string_number_end.
+static char *string_number_begin(String *dest, size_t max_length, Arena *arena, ArenaError *error)
+{
+    *error = string_grow_arena(dest, dest->length + max_length + 1, arena);
+    return *error == ARENA_SUCCESS ? dest->data + dest->length : NULL;
+}
+
+static void string_number_end(String *dest, size_t length)
+{
+    dest->length += length;
+    dest->data[dest->length] = '\0';
+    dest->hash = 0;
+}
+
+ArenaError string_append_i64_arena(String *dest, int64_t value, Arena *arena)
+{
+    uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+    ArenaError error;
+    char *out = string_number_begin(dest, (value < 0) + count_digits_u64(magnitude), arena, &error);
+    if (out) {
+        string_number_end(dest, format_i64(out, value));
+    }
+    return error;
+}
+
+ArenaError string_append_u64_arena(String *dest, uint64_t value, Arena *arena)
+{
+    ArenaError error;
+    char *out = string_number_begin(dest, count_digits_u64(value), arena, &error);
+    if (out) {
+        string_number_end(dest, format_u64(out, value));
+    }
+    return error;
+}
+
+ArenaError string_append_hex_arena(String *dest, uint64_t value, Arena *arena)
+{
+    ArenaError error;
+    char *out = string_number_begin(dest, 16, arena, &error);
+    if (out) {
+        string_number_end(dest, format_hex(out, value));
+    }
+    return error;
+}
+
+ArenaError string_append_double_arena(String *dest, double value, Arena *arena)
+{
+    ArenaError error;
+    char *out = string_number_begin(dest, NUMBER_BUFFER_SIZE, arena, &error);
+    if (out) {
+        string_number_end(dest, format_double(out, value));
+    }
+    return error;
+}
+
+ArenaError string_append_i64_malloc(String *dest, int64_t value)
+{
+    return string_append_i64_arena(dest, value, NULL);
+}
+
+ArenaError string_append_u64_malloc(String *dest, uint64_t value)
+{
+    return string_append_u64_arena(dest, value, NULL);
+}
+
+ArenaError string_append_hex_malloc(String *dest, uint64_t value)
+{
+    return string_append_hex_arena(dest, value, NULL);
+}
+
+ArenaError string_append_double_malloc(String *dest, double value)
+{
+    return string_append_double_arena(dest, value, NULL);
+}
+
+// ---- Parsing ----
+
+static bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// Loads 8 bytes as a little endian word
+static uint64_t load_u64_le(const char *p)
+{
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    return value;
+}
+
+// SWAR check whether all 8 bytes are ASCII digits
+static bool is_eight_digits(uint64_t value)
+{
+    return (((value & UINT64_C(0xF0F0F0F0F0F0F0F0)) |
+             (((value + UINT64_C(0x0606060606060606)) & UINT64_C(0xF0F0F0F0F0F0F0F0)) >> 4)) ==
+            UINT64_C(0x3333333333333333));
+}
+
+// SWAR conversion of 8 ASCII digits (first digit in the lowest byte) to their value
+static uint32_t parse_eight_digits(uint64_t value)
+{
+    const uint64_t mask = UINT64_C(0x000000FF000000FF);
+    const uint64_t mul1 = UINT64_C(0x000F424000000064); // 100 + (1000000 << 32)
+    const uint64_t mul2 = UINT64_C(0x0000271000000001); // 1 + (10000 << 32)
+    value -= UINT64_C(0x3030303030303030);
+    value = (value * 10) + (value >> 8); // value = (value * 2561) >> 8
+    value = (((value & mask) * mul1) + (((value >> 16) & mask) * mul2)) >> 32;
+    return (uint32_t)value;
+}
+
+// Accumulates count digits starting at p into value, count must keep value below 2^64
+static uint64_t accumulate_digits(const char *p, size_t count, uint64_t value)
+{
+    while (count >= 8) {
+        value = value * 100000000 + parse_eight_digits(load_u64_le(p));
+        p += 8;
+        count -= 8;
+    }
+    while (count > 0) {
+        value = value * 10 + (uint64_t)(*p++ - '0');
+        count--;
+    }
+    return value;
+}
+
+// Counts the digits at the start of p, 8 at a time where possible
+static size_t count_leading_digits(const char *p, size_t len)
+{
+    size_t n = 0;
+    while (n + 8 <= len && is_eight_digits(load_u64_le(p + n))) {
+        n += 8;
+    }
+    while (n < len && is_digit(p[n])) {
+        n++;
+    }
+    return n;
+}
+
+static StringParseResult parse_result(size_t consumed, StringParseStatus status)
+{
+    StringParseResult result = { consumed, status };
+    return result;
+}
+
+// Parses the digits at the start of view into *value, without a sign
+static StringParseResult parse_magnitude(StringView view, size_t offset, uint64_t *value)
+{
+    size_t digits = count_leading_digits(view.ptr + offset, view.len - offset);
+    if (digits == 0) {
+        *value = 0;
+        return parse_result(0, STRING_PARSE_INVALID);
+    }
+
+    const char *p = view.ptr + offset;
+    size_t consumed = offset + digits;
+
+    // Leading zeros do not count towards overflow
+    while (digits > 1 && *p == '0') {
+        p++;
+        digits--;
+    }
+
+    // Up to 19 digits always fit into 64 bits
+    if (digits <= 19) {
+        *value = accumulate_digits(p, digits, 0);
+        return parse_result(consumed, STRING_PARSE_OK);
+    }
+
+    if (digits == 20) {
+        uint64_t high = accumulate_digits(p, 19, 0);
+        uint64_t last = (uint64_t)(p[19] - '0');
+        if (high <= (UINT64_MAX - last) / 10) {
+            *value = high * 10 + last;
+            return parse_result(consumed, STRING_PARSE_OK);
+        }
+    }
+
+    *value = UINT64_MAX;
+    return parse_result(consumed, STRING_PARSE_OVERFLOW);
+}
+
+StringParseResult string_view_parse_u64(StringView view, uint64_t *value)
+{
+    size_t offset = (view.len > 0 && view.ptr[0] == '+') ? 1 : 0;
+    StringParseResult result = parse_magnitude(view, offset, value);
+    if (result.status == STRING_PARSE_INVALID) {
+        result.consumed = 0;
+    }
+    return result;
+}
+
+StringParseResult string_view_parse_i64(StringView view, int64_t *value)
+{
+    bool negative = view.len > 0 && view.ptr[0] == '-';
+    size_t offset = (view.len > 0 && (view.ptr[0] == '-' || view.ptr[0] == '+')) ? 1 : 0;
+
+    uint64_t magnitude;
+    StringParseResult result = parse_magnitude(view, offset, &magnitude);
+    if (result.status == STRING_PARSE_INVALID) {
+        *value = 0;
+        return result;
+    }
+
+    uint64_t limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+    if (result.status == STRING_PARSE_OVERFLOW || magnitude > limit) {
+        *value = negative ? INT64_MIN : INT64_MAX;
+        result.status = STRING_PARSE_OVERFLOW;
+        return result;
+    }
+
+    *value = negative ? (int64_t)(0 - magnitude) : (int64_t)magnitude;
+    return result;
+}
+
+StringParseResult string_parse_u64(const String *string, uint64_t *value)
+{
+    return string_view_parse_u64(string_view_from_string(string), value);
+}
+
+StringParseResult string_parse_i64(const String *string, int64_t *value)
+{
+    return string_view_parse_i64(string_view_from_string(string), value);
+}
+
+#if FLT_EVAL_METHOD == 0
+// Exact powers of ten for the Clinger fast path
+static const double exact_powers_of_ten[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+#endif
+
+#define DOUBLE_INFINITY_BITS UINT64_C(0x7FF0000000000000)
+
+// Eisel-Lemire: computes the bits of the double closest to w * 10^q (w != 0) from a 128 bit
+// approximation of 5^q. The product is always precise enough for w of at most 19 digits
+// (Mushtak and Lemire, "Fast Number Parsing Without Fallback").
+static uint64_t eisel_lemire(int64_t q, uint64_t w)
+{
+    if (q < POW5_TABLE_SMALLEST_POWER) {
+        return 0;
+    }
+    if (q > POW5_TABLE_LARGEST_POWER) {
+        return DOUBLE_INFINITY_BITS;
+    }
+
+    int lz = cs_clz64(w);
+    w <<= lz;
+
+    size_t index = 2 * (size_t)(q - POW5_TABLE_SMALLEST_POWER);
+    uint64_t high;
+    uint64_t low = cs_mul128(w, pow5_table_128[index], &high);
+
+    // Only if the bits that decide the rounding are all ones the lower half of 5^q matters
+    const uint64_t precision_mask = UINT64_MAX >> (DP_SIGNIFICAND_SIZE + 3);
+    if ((high & precision_mask) == precision_mask) {
+        uint64_t second_high;
+        cs_mul128(w, pow5_table_128[index + 1], &second_high);
+        low += second_high;
+        if (second_high > low) {
+            high++;
+        }
+    }
+
+    int upper_bit = (int)(high >> 63);
+    int shift = upper_bit + 64 - DP_SIGNIFICAND_SIZE - 3;
+    uint64_t mantissa = high >> shift;
+    // floor(log2(10^q)) + 63 gives the binary exponent of the product
+    int32_t power2 = (int32_t)((((152170 + 65536) * (int32_t)q) >> 16) + 63) + upper_bit - lz + 1023;
+
+    if (power2 <= 0) {
+        // Subnormal result
+        if (-power2 + 1 >= 64) {
+            return 0;
+        }
+        mantissa >>= -power2 + 1;
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+        power2 = mantissa < DP_HIDDEN_BIT ? 0 : 1;
+        return ((uint64_t)power2 << DP_SIGNIFICAND_SIZE) | (mantissa & DP_SIGNIFICAND_MASK);
+    }
+
+    // Exactly halfway between two doubles, round to even instead of up
+    if (low <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1) {
+        if ((mantissa << shift) == high) {
+            mantissa &= ~UINT64_C(1);
+        }
+    }
+
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >= (DP_HIDDEN_BIT << 1)) {
+        mantissa = DP_HIDDEN_BIT;
+        power2++;
+    }
+    mantissa &= ~DP_HIDDEN_BIT;
+
+    if (power2 >= 0x7FF) {
+        return DOUBLE_INFINITY_BITS;
+    }
+    return ((uint64_t)power2 << DP_SIGNIFICAND_SIZE) | mantissa;
+}
+
+// Slow path for inputs with more than 19 significant digits that Eisel-Lemire can not decide
+// (the digit comparison of the fast_float project). The answer is either the double rounded
+// from the first 19 digits or the next one up, so the exact decimal value is compared with the
+// halfway point between the two. Both sides are scaled to integers and compared as big integers.
+
+// A halfway point between two doubles has at most 767 significant digits. Longer inputs are
+// cut off and a nonzero rest is replaced with a single digit 1, which keeps the comparison exact.
+#define DECIMAL_MAX_DIGITS 800
+
+// 32 bit limbs, least significant first. Both sides of the comparison stay below 2^2700 for
+// inputs that reach the slow path (decimal exponent -1124 ... 308, at most 801 digits).
+#define DECIMAL_BIGINT_LIMBS 128
+
+typedef struct
+{
+    uint32_t limbs[DECIMAL_BIGINT_LIMBS];
+    size_t count;
+} DecimalBigint;
+
+static void decimal_bigint_init(DecimalBigint *big, uint64_t value)
+{
+    big->limbs[0] = (uint32_t)value;
+    big->limbs[1] = (uint32_t)(value >> 32);
+    big->count = big->limbs[1] ? 2 : big->limbs[0] ? 1 : 0;
+}
+
+// big = big * factor + addend
+static void decimal_bigint_mul_add(DecimalBigint *big, uint32_t factor, uint32_t addend)
+{
+    uint64_t carry = addend;
+    for (size_t i = 0; i < big->count; i++) {
+        uint64_t product = (uint64_t)big->limbs[i] * factor + carry;
+        big->limbs[i] = (uint32_t)product;
+        carry = product >> 32;
+    }
+    if (carry && big->count < DECIMAL_BIGINT_LIMBS) {
+        big->limbs[big->count++] = (uint32_t)carry;
+    }
+}
+
+static void decimal_bigint_mul_pow5(DecimalBigint *big, unsigned exponent)
+{
+    // 5^13 is the largest power of five that fits in a limb
+    for (; exponent >= 13; exponent -= 13) {
+        decimal_bigint_mul_add(big, 1220703125u, 0);
+    }
+    uint32_t factor = 1;
+    for (; exponent > 0; exponent--) {
+        factor *= 5;
+    }
+    if (factor > 1) {
+        decimal_bigint_mul_add(big, factor, 0);
+    }
+}
+
+static void decimal_bigint_shift_left(DecimalBigint *big, unsigned bits)
+{
+    if (big->count == 0) {
+        return;
+    }
+    size_t limbs = bits / 32;
+    unsigned shift = bits % 32;
+
+    if (shift > 0 && big->count < DECIMAL_BIGINT_LIMBS) {
+        big->limbs[big->count++] = 0;
+    }
+    for (size_t i = big->count; i-- > 0;) {
+        uint32_t value = big->limbs[i] << shift;
+        if (shift > 0 && i > 0) {
+            value |= big->limbs[i - 1] >> (32 - shift);
+        }
+        if (i + limbs < DECIMAL_BIGINT_LIMBS) {
+            big->limbs[i + limbs] = value;
+        }
+    }
+    memset(big->limbs, 0, limbs * sizeof(uint32_t));
+    big->count = big->count + limbs < DECIMAL_BIGINT_LIMBS ? big->count + limbs : DECIMAL_BIGINT_LIMBS;
+    while (big->count > 0 && big->limbs[big->count - 1] == 0) {
+        big->count--;
+    }
+}
+
+static int decimal_bigint_compare(const DecimalBigint *a, const DecimalBigint *b)
+{
+    if (a->count != b->count) {
+        return a->count < b->count ? -1 : 1;
+    }
+    for (size_t i = a->count; i-- > 0;) {
+        if (a->limbs[i] != b->limbs[i]) {
+            return a->limbs[i] < b->limbs[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+// Decides between bits and the next double up for the number in p[0, len), which Eisel-Lemire
+// saw as mantissa * 10^exponent with mantissa holding its first 19 significant digits.
+static uint64_t parse_double_slow(const char *p, size_t len, int64_t exponent, uint64_t bits)
+{
+    // All significant digits as one integer, 9 at a time
+    DecimalBigint decimal;
+    decimal_bigint_init(&decimal, 0);
+    size_t digits = 0;
+    uint32_t chunk = 0;
+    unsigned chunk_digits = 0;
+    bool dropped = false;
+
+    for (size_t i = 0; i < len && p[i] != 'e' && p[i] != 'E'; i++) {
+        if (!is_digit(p[i])) {
+            continue; // Sign or decimal point
+        }
+        unsigned d = (unsigned)(p[i] - '0');
+        if (digits == 0 && d == 0) {
+            continue; // Leading zero
+        }
+        if (digits == DECIMAL_MAX_DIGITS) {
+            dropped |= d != 0;
+            continue;
+        }
+        chunk = chunk * 10 + d;
+        digits++;
+        if (++chunk_digits == 9) {
+            decimal_bigint_mul_add(&decimal, 1000000000u, chunk);
+            chunk = 0;
+            chunk_digits = 0;
+        }
+    }
+    if (dropped) {
+        chunk = chunk * 10 + 1;
+        digits++;
+        chunk_digits++;
+    }
+    if (chunk_digits > 0) {
+        uint32_t scale = 1;
+        for (unsigned i = 0; i < chunk_digits; i++) {
+            scale *= 10;
+        }
+        decimal_bigint_mul_add(&decimal, scale, chunk);
+    }
+    int64_t decimal_exponent = exponent - (int64_t)(digits - 19);
+
+    // The halfway point (2 * significand + 1) * 2^(binary_exponent - 1)
+    int biased_e = (int)((bits & DP_EXPONENT_MASK) >> DP_SIGNIFICAND_SIZE);
+    uint64_t significand = bits & DP_SIGNIFICAND_MASK;
+    int64_t binary_exponent = DP_MIN_EXPONENT + 1;
+    if (biased_e != 0) {
+        significand += DP_HIDDEN_BIT;
+        binary_exponent = biased_e - DP_EXPONENT_BIAS;
+    }
+    DecimalBigint halfway;
+    decimal_bigint_init(&halfway, 2 * significand + 1);
+
+    // decimal * 5^a * 2^a against halfway * 5^b * 2^(binary_exponent - 1 + b), one of a and b is 0
+    int64_t decimal_power2 = 0;
+    int64_t halfway_power2 = binary_exponent - 1;
+    if (decimal_exponent >= 0) {
+        decimal_bigint_mul_pow5(&decimal, (unsigned)decimal_exponent);
+        decimal_power2 += decimal_exponent;
+    } else {
+        decimal_bigint_mul_pow5(&halfway, (unsigned)-decimal_exponent);
+        halfway_power2 -= decimal_exponent;
+    }
+    if (decimal_power2 > halfway_power2) {
+        decimal_bigint_shift_left(&decimal, (unsigned)(decimal_power2 - halfway_power2));
+    } else {
+        decimal_bigint_shift_left(&halfway, (unsigned)(halfway_power2 - decimal_power2));
+    }
+
+    int order = decimal_bigint_compare(&decimal, &halfway);
+    if (order > 0 || (order == 0 && (bits & 1))) {
+        return bits + 1; // Exactly halfway rounds to even
+    }
+    return bits;
+}
+
+// Case-insensitive match of a lowercase word at the start of p
+static bool starts_with_word(const char *p, size_t len, const char *word)
+{
+    size_t word_len = strlen(word);
+    if (len < word_len) {
+        return false;
+    }
+    for (size_t i = 0; i < word_len; i++) {
+        if ((p[i] | 0x20) != word[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+StringParseResult string_view_parse_double(StringView view, double *value)
+{
+    const char *p = view.ptr;
+    const char *end = view.ptr + view.len;
+    bool negative = false;
+
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+
+    if (starts_with_word(p, (size_t)(end - p), "inf")) {
+        size_t word = starts_with_word(p, (size_t)(end - p), "infinity") ? 8 : 3;
+        *value = negative ? -HUGE_VAL : HUGE_VAL;
+        return parse_result((size_t)(p - view.ptr) + word, STRING_PARSE_OK);
+    }
+    if (starts_with_word(p, (size_t)(end - p), "nan")) {
+        *value = negative ? -NAN : NAN;
+        return parse_result((size_t)(p - view.ptr) + 3, STRING_PARSE_OK);
+    }
+
+    uint64_t mantissa = 0;
+    int64_t exponent = 0;
+    size_t significant = 0; // Digits stored in mantissa
+    size_t digits = 0;      // All digits seen
+    bool truncated = false; // Non-zero digits were dropped because mantissa is full
+
+    // Integer part
+    for (;;) {
+        if (significant > 0 && significant + 8 <= 19 && end - p >= 8 && is_eight_digits(load_u64_le(p))) {
+            mantissa = mantissa * 100000000 + parse_eight_digits(load_u64_le(p));
+            significant += 8;
+            digits += 8;
+            p += 8;
+            continue;
+        }
+        if (p == end || !is_digit(*p)) {
+            break;
+        }
+        unsigned d = (unsigned)(*p++ - '0');
+        digits++;
+        if (mantissa == 0 && d == 0) {
+            continue; // Leading zero
+        }
+        if (significant < 19) {
+            mantissa = mantissa * 10 + d;
+            significant++;
+        } else {
+            truncated |= d != 0;
+            exponent++;
+        }
+    }
+
+    // Fractional part
+    if (p < end && *p == '.') {
+        p++;
+        for (;;) {
+            if (significant > 0 && significant + 8 <= 19 && end - p >= 8 && is_eight_digits(load_u64_le(p))) {
+                mantissa = mantissa * 100000000 + parse_eight_digits(load_u64_le(p));
+                significant += 8;
+                digits += 8;
+                exponent -= 8;
+                p += 8;
+                continue;
+            }
+            if (p == end || !is_digit(*p)) {
+                break;
+            }
+            unsigned d = (unsigned)(*p++ - '0');
+            digits++;
+            if (mantissa == 0 && d == 0) {
+                exponent--;
+            } else if (significant < 19) {
+                mantissa = mantissa * 10 + d;
+                significant++;
+                exponent--;
+            } else {
+                truncated |= d != 0;
+            }
+        }
+    }
+
+    if (digits == 0) {
+        *value = 0.0;
+        return parse_result(0, STRING_PARSE_INVALID);
+    }
+
+    // Exponent, only consumed if at least one digit follows the 'e'
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char *q = p + 1;
+        bool exponent_negative = false;
+        if (q < end && (*q == '-' || *q == '+')) {
+            exponent_negative = *q == '-';
+            q++;
+        }
+        if (q < end && is_digit(*q)) {
+            int64_t explicit_exponent = 0;
+            while (q < end && is_digit(*q)) {
+                // Anything this large is zero or infinity anyway
+                if (explicit_exponent < 100000) {
+                    explicit_exponent = explicit_exponent * 10 + (*q - '0');
+                }
+                q++;
+            }
+            exponent += exponent_negative ? -explicit_exponent : explicit_exponent;
+            p = q;
+        }
+    }
+
+    size_t consumed = (size_t)(p - view.ptr);
+    double result;
+
+    if (mantissa == 0) {
+        result = 0.0;
+    }
+#if FLT_EVAL_METHOD == 0
+    // Clinger: both operands are exact doubles, so a single rounding gives the exact answer
+    else if (!truncated && mantissa <= (UINT64_C(1) << 53) && exponent >= -22 && exponent <= 22) {
+        result = (double)mantissa;
+        result = exponent < 0 ? result / exact_powers_of_ten[-exponent] : result * exact_powers_of_ten[exponent];
+    }
+#endif
+    else {
+        uint64_t bits = eisel_lemire(exponent, mantissa);
+        // With dropped digits the true value lies between mantissa and mantissa + 1
+        if (truncated && (mantissa == UINT64_MAX || eisel_lemire(exponent, mantissa + 1) != bits)) {
+            bits = parse_double_slow(view.ptr, consumed, exponent, bits);
+        }
+        memcpy(&result, &bits, sizeof(result));
+    }
+
+    *value = negative ? -result : result;
+    if (isinf(result)) {
+        return parse_result(consumed, STRING_PARSE_OVERFLOW);
+    }
+    return parse_result(consumed, STRING_PARSE_OK);
+}
+
+StringParseResult string_parse_double(const String *string, double *value)
+{
+    return string_view_parse_double(string_view_from_string(string), value);
+}
@@ -0,0 +1,295 @@
+// Thread-local pools of size-classed buffers.
+//
+// Every buffer is preceded by a StringPoolBlock that remembers its size class and the thread
+// cache that created it. The owning thread keeps released blocks in per-class free lists. Other
+// threads push blocks onto the owner's remote stack, a Treiber stack that only the owner
+// empties, all at once, so pushes need a single compare-and-swap and there is no ABA problem.
+// The owner empties it on a cache miss and whenever it releases a buffer. Both the free lists and the
+// remote stack hold at most STRING_POOL_CACHE_BYTES, blocks beyond that go back to free.
+//
+// A cache stays alive while its thread runs or any of its blocks is handed out. refs counts
+// both, whoever drops it to zero frees the cache, after the owning thread has exited.
+
+#include "string_pool.h"
+#include "c_string_internal.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+
+#define STRING_POOL_MIN_SHIFT 6 // Smallest class holds 64 bytes
+#define STRING_POOL_CLASSES 11  // 64 bytes to 64 KiB
+
+_Static_assert(((size_t)1 << (STRING_POOL_MIN_SHIFT + STRING_POOL_CLASSES - 1)) == STRING_POOL_MAX_BUFFER,
+               "size classes do not end at STRING_POOL_MAX_BUFFER");
+_Static_assert(sizeof(String) <= ((size_t)1 << STRING_POOL_MIN_SHIFT), "String headers must fit the smallest class");
+
+struct StringPoolThread;
+
+typedef struct StringPoolBlock
+{
+    struct StringPoolBlock *next;   // Link in a free list or the remote stack
+    struct StringPoolThread *owner; // Cache the block returns to, NULL if it is not pooled
+    size_t size_class;              // Index of the size class
+    size_t reserved;                // Keeps the buffer behind the header 16 byte aligned
+} StringPoolBlock;
+
+_Static_assert(sizeof(StringPoolBlock) % 16 == 0, "pool buffers must stay aligned");
+
+typedef struct StringPoolThread
+{
+    StringPoolBlock *free_lists[STRING_POOL_CLASSES]; // Only touched by the owning thread
+    size_t cached_bytes;                              // Bytes in all free lists together
+    _Atomic(StringPoolBlock *) remote;                // Blocks released by other threads
+    atomic_size_t remote_bytes;                       // Bytes on the remote stack or about to be pushed
+    atomic_size_t refs;                               // 1 while the thread runs, plus blocks handed out
+} StringPoolThread;
+
+static _Thread_local StringPoolThread *string_pool_current;
+
+// Only used for its destructor, which runs when a thread that used the pool exits
+static tss_t string_pool_exit_key;
+static bool string_pool_exit_key_created;
+static once_flag string_pool_once = ONCE_FLAG_INIT;
+
+static size_t string_pool_class_size(size_t size_class)
+{
+    return (size_t)1 << (size_class + STRING_POOL_MIN_SHIFT);
+}
+
+static size_t string_pool_class_for(size_t size)
+{
+    size_t size_class = 0;
+    while (string_pool_class_size(size_class) < size) {
+        size_class++;
+    }
+    return size_class;
+}
+
+static StringPoolBlock *string_pool_block(char *buffer)
+{
+    return (StringPoolBlock *)buffer - 1;
+}
+
+// Moves a block into a free list of the owning thread, or frees it if the cache is full
+static void string_pool_cache(StringPoolThread *pool, StringPoolBlock *block)
+{
+    size_t size_class = block->size_class;
+    size_t size = string_pool_class_size(size_class);
+    if (pool->cached_bytes + size > STRING_POOL_CACHE_BYTES) {
+        free(block);
+        return;
+    }
+    block->next = pool->free_lists[size_class];
+    pool->free_lists[size_class] = block;
+    pool->cached_bytes += size;
+}
+
+// Takes all blocks released by other threads
+static StringPoolBlock *string_pool_take_remote(StringPoolThread *pool)
+{
+    StringPoolBlock *remote = atomic_exchange_explicit(&pool->remote, NULL, memory_order_acquire);
+    size_t bytes = 0;
+    for (StringPoolBlock *block = remote; block; block = block->next) {
+        bytes += string_pool_class_size(block->size_class);
+    }
+    if (bytes > 0) {
+        atomic_fetch_sub_explicit(&pool->remote_bytes, bytes, memory_order_relaxed);
+    }
+    return remote;
+}
+
+// Moves the blocks released by other threads into the free lists
+static void string_pool_drain_remote(StringPoolThread *pool)
+{
+    StringPoolBlock *remote = string_pool_take_remote(pool);
+    while (remote) {
+        StringPoolBlock *next = remote->next;
+        string_pool_cache(pool, remote);
+        remote = next;
+    }
+}
+
+static void string_pool_free_list(StringPoolBlock *block)
+{
+    while (block) {
+        StringPoolBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+}
+
+static void string_pool_trim_cache(StringPoolThread *pool)
+{
+    for (size_t i = 0; i < STRING_POOL_CLASSES; i++) {
+        string_pool_free_list(pool->free_lists[i]);
+        pool->free_lists[i] = NULL;
+    }
+    pool->cached_bytes = 0;
+    string_pool_free_list(string_pool_take_remote(pool));
+}
+
+// Drops a reference, the last one frees the cache together with blocks still on the remote stack
+static void string_pool_unref(StringPoolThread *pool)
+{
+    if (atomic_fetch_sub_explicit(&pool->refs, 1, memory_order_acq_rel) == 1) {
+        string_pool_free_list(string_pool_take_remote(pool));
+        free(pool);
+    }
+}
+
+static void string_pool_thread_exit(void *value)
+{
+    StringPoolThread *pool = value;
+    string_pool_current = NULL;
+    string_pool_trim_cache(pool);
+    string_pool_unref(pool);
+}
+
+static void string_pool_create_exit_key(void)
+{
+    string_pool_exit_key_created = tss_create(&string_pool_exit_key, string_pool_thread_exit) == thrd_success;
+}
+
+// Returns the cache of the calling thread, creating it on first use. NULL if that fails,
+// buffers are then allocated without a pool.
+static StringPoolThread *string_pool_thread(void)
+{
+    StringPoolThread *pool = string_pool_current;
+    if (pool) {
+        return pool;
+    }
+
+    call_once(&string_pool_once, string_pool_create_exit_key);
+    if (!string_pool_exit_key_created) {
+        return NULL;
+    }
+
+    pool = calloc(1, sizeof(StringPoolThread));
+    if (pool == NULL) {
+        return NULL;
+    }
+    atomic_init(&pool->remote, NULL);
+    atomic_init(&pool->remote_bytes, 0);
+    atomic_init(&pool->refs, 1);
+
+    if (tss_set(string_pool_exit_key, pool) != thrd_success) {
+        free(pool);
+        return NULL;
+    }
+    string_pool_current = pool;
+    return pool;
+}
+
+char *string_pool_acquire_buffer(size_t size, size_t *capacity)
+{
+    if (size > STRING_POOL_MAX_BUFFER) {
+        return NULL;
+    }
+
+    size_t size_class = string_pool_class_for(size);
+    StringPoolThread *pool = string_pool_thread();
+    StringPoolBlock *block = NULL;
+
+    if (pool) {
+        if (pool->free_lists[size_class] == NULL) {
+            // Collect what other threads gave back before asking malloc
+            string_pool_drain_remote(pool);
+        }
+        block = pool->free_lists[size_class];
+        if (block) {
+            pool->free_lists[size_class] = block->next;
+            pool->cached_bytes -= string_pool_class_size(size_class);
+        }
+    }
+
+    if (block == NULL) {
+        block = malloc(sizeof(StringPoolBlock) + string_pool_class_size(size_class));
+        if (block == NULL) {
+            return NULL;
+        }
+        block->owner = pool;
+        block->size_class = size_class;
+    }
+
+    if (pool) {
+        atomic_fetch_add_explicit(&pool->refs, 1, memory_order_relaxed);
+    }
+    *capacity = string_pool_class_size(size_class);
+    return (char *)(block + 1);
+}
+
+void string_pool_release_buffer(char *buffer)
+{
+    StringPoolBlock *block = string_pool_block(buffer);
+    StringPoolThread *owner = block->owner;
+
+    if (owner == NULL) {
+        free(block);
+        return;
+    }
+
+    if (owner == string_pool_current) {
+        // The owner holds a reference of its own, this can not drop the last one
+        string_pool_cache(owner, block);
+        if (atomic_load_explicit(&owner->remote, memory_order_relaxed)) {
+            string_pool_drain_remote(owner);
+        }
+        atomic_fetch_sub_explicit(&owner->refs, 1, memory_order_relaxed);
+        return;
+    }
+
+    // Hand the block back to its owner, unless the owner already has a full cache worth waiting
+    size_t size = string_pool_class_size(block->size_class);
+    if (atomic_fetch_add_explicit(&owner->remote_bytes, size, memory_order_relaxed) + size > STRING_POOL_CACHE_BYTES) {
+        atomic_fetch_sub_explicit(&owner->remote_bytes, size, memory_order_relaxed);
+        free(block);
+    } else {
+        StringPoolBlock *head = atomic_load_explicit(&owner->remote, memory_order_relaxed);
+        do {
+            block->next = head;
+        } while (!atomic_compare_exchange_weak_explicit(&owner->remote, &head, block, memory_order_release,
+                                                        memory_order_relaxed));
+    }
+    string_pool_unref(owner);
+}
+
+String *string_builder_acquire(size_t capacity)
+{
+    size_t header_capacity;
+    String *builder = (String *)string_pool_acquire_buffer(sizeof(String), &header_capacity);
+    if (builder == NULL) {
+        return NULL;
+    }
+
+    builder->data = builder->inline_data;
+    builder->length = 0;
+    builder->capacity = STRING_INLINE_CAPACITY;
+    builder->hash = 0;
+    builder->flags = STRING_FLAG_POOLED_HEADER;
+    builder->inline_data[0] = '\0';
+
+    if (capacity >= STRING_INLINE_CAPACITY && string_reserve_malloc(builder, capacity) != ARENA_SUCCESS) {
+        string_free(builder);
+        return NULL;
+    }
+    return builder;
+}
+
+void string_builder_release(String *builder)
+{
+    string_free(builder);
+}
+
+void string_pool_trim(void)
+{
+    if (string_pool_current) {
+        string_pool_trim_cache(string_pool_current);
+    }
+}
+
+size_t string_pool_cached_bytes(void)
+{
+    StringPoolThread *pool = string_pool_current;
+    return pool ? pool->cached_bytes : 0;
+}
@@ -0,0 +1,374 @@
+#include "string_rope.h"
+#include "c_string_internal.h"
+#include <stdalign.h>
+#include <string.h>
+
+// State shared by the recursive helpers of a single operation. A failed allocation is remembered
+// in failed, the operation then discards everything it built and leaves the rope untouched.
+typedef struct
+{
+    ChunkArena *arena;
+    bool failed;
+} RopeBuilder;
+
+static unsigned rope_height(const RopeNode *node)
+{
+    return node ? node->height : 0;
+}
+
+static size_t rope_node_length(const RopeNode *node)
+{
+    return node ? node->length : 0;
+}
+
+static bool rope_is_leaf(const RopeNode *node)
+{
+    return node->left == NULL && node->right == NULL;
+}
+
+static RopeNode *rope_alloc_node(RopeBuilder *builder)
+{
+    if (builder->failed) {
+        return NULL;
+    }
+    RopeNode *node = chunk_arena_allocate(builder->arena, sizeof(RopeNode), alignof(RopeNode));
+    if (node == NULL) {
+        builder->failed = true;
+    }
+    return node;
+}
+
+// Creates a leaf that refers to existing (immutable) bytes
+static RopeNode *rope_leaf(RopeBuilder *builder, const char *bytes, size_t length)
+{
+    if (length == 0) {
+        return NULL;
+    }
+    RopeNode *node = rope_alloc_node(builder);
+    if (node == NULL) {
+        return NULL;
+    }
+    node->left = NULL;
+    node->right = NULL;
+    node->bytes = bytes;
+    node->length = length;
+    node->height = 0;
+    return node;
+}
+
+// Creates an inner node. Two small leaves are merged into one, so many tiny edits do not
+// fragment the rope into tiny chunks.
+static RopeNode *rope_node(RopeBuilder *builder, RopeNode *left, RopeNode *right)
+{
+    if (left == NULL) {
+        return right;
+    }
+    if (right == NULL) {
+        return left;
+    }
+
+    if (rope_is_leaf(left) && rope_is_leaf(right) && left->length + right->length <= ROPE_LEAF_MAX) {
+        if (builder->failed) {
+            return NULL;
+        }
+        char *bytes = chunk_arena_allocate(builder->arena, left->length + right->length, alignof(char));
+        if (bytes == NULL) {
+            builder->failed = true;
+            return NULL;
+        }
+        memcpy(bytes, left->bytes, left->length);
+        memcpy(bytes + left->length, right->bytes, right->length);
+        return rope_leaf(builder, bytes, left->length + right->length);
+    }
+
+    RopeNode *node = rope_alloc_node(builder);
+    if (node == NULL) {
+        return NULL;
+    }
+    node->left = left;
+    node->right = right;
+    node->bytes = NULL;
+    node->length = left->length + right->length;
+    unsigned left_height = rope_height(left), right_height = rope_height(right);
+    node->height = 1 + (left_height > right_height ? left_height : right_height);
+    return node;
+}
+
+// Creates a node from two subtrees whose heights differ by at most 2 and rotates it back
+// into AVL balance.
+static RopeNode *rope_balance(RopeBuilder *builder, RopeNode *left, RopeNode *right)
+{
+    unsigned left_height = rope_height(left), right_height = rope_height(right);
+
+    if (left && left_height > right_height + 1) {
+        if (rope_height(left->left) >= rope_height(left->right)) {
+            return rope_node(builder, left->left, rope_node(builder, left->right, right));
+        }
+        RopeNode *pivot = left->right;
+        return rope_node(builder, rope_node(builder, left->left, pivot->left),
+                         rope_node(builder, pivot->right, right));
+    }
+
+    if (right && right_height > left_height + 1) {
+        if (rope_height(right->right) >= rope_height(right->left)) {
+            return rope_node(builder, rope_node(builder, left, right->left), right->right);
+        }
+        RopeNode *pivot = right->left;
+        return rope_node(builder, rope_node(builder, left, pivot->left),
+                         rope_node(builder, pivot->right, right->right));
+    }
+
+    return rope_node(builder, left, right);
+}
+
+// Concatenates two balanced trees in O(|height difference|)
+static RopeNode *rope_join(RopeBuilder *builder, RopeNode *left, RopeNode *right)
+{
+    if (left == NULL) {
+        return right;
+    }
+    if (right == NULL) {
+        return left;
+    }
+
+    unsigned left_height = rope_height(left), right_height = rope_height(right);
+    if (left_height > right_height + 1) {
+        return rope_balance(builder, left->left, rope_join(builder, left->right, right));
+    }
+    if (right_height > left_height + 1) {
+        return rope_balance(builder, rope_join(builder, left, right->left), right->right);
+    }
+    return rope_node(builder, left, right);
+}
+
+// Splits a tree into the first pos bytes and the rest
+static void rope_split(RopeBuilder *builder, RopeNode *node, size_t pos, RopeNode **left, RopeNode **right)
+{
+    if (node == NULL || pos == 0) {
+        *left = NULL;
+        *right = node;
+        return;
+    }
+    if (pos >= node->length) {
+        *left = node;
+        *right = NULL;
+        return;
+    }
+
+    if (rope_is_leaf(node)) {
+        // Both halves keep pointing at the original bytes
+        *left = rope_leaf(builder, node->bytes, pos);
+        *right = rope_leaf(builder, node->bytes + pos, node->length - pos);
+        return;
+    }
+
+    size_t left_length = node->left->length;
+    if (pos == left_length) {
+        *left = node->left;
+        *right = node->right;
+    } else if (pos < left_length) {
+        RopeNode *a, *b;
+        rope_split(builder, node->left, pos, &a, &b);
+        *left = a;
+        *right = rope_join(builder, b, node->right);
+    } else {
+        RopeNode *a, *b;
+        rope_split(builder, node->right, pos - left_length, &a, &b);
+        *left = rope_join(builder, node->left, a);
+        *right = b;
+    }
+}
+
+// Builds a perfectly balanced tree over bytes that already live in the arena
+static RopeNode *rope_build(RopeBuilder *builder, const char *bytes, size_t length)
+{
+    if (length <= ROPE_LEAF_MAX) {
+        return rope_leaf(builder, bytes, length);
+    }
+
+    size_t leaves = (length + ROPE_LEAF_MAX - 1) / ROPE_LEAF_MAX;
+    size_t left_length = (leaves / 2) * ROPE_LEAF_MAX;
+    RopeNode *left = rope_build(builder, bytes, left_length);
+    RopeNode *right = rope_build(builder, bytes + left_length, length - left_length);
+    return rope_node(builder, left, right);
+}
+
+static RopeBuilder rope_builder(const Rope *rope)
+{
+    RopeBuilder builder = { rope->arena, false };
+    return builder;
+}
+
+void rope_init(Rope *rope, ChunkArena *arena)
+{
+    rope->root = NULL;
+    rope->arena = arena;
+}
+
+size_t rope_length(const Rope *rope)
+{
+    return rope_node_length(rope->root);
+}
+
+char rope_char_at(const Rope *rope, size_t index)
+{
+    const RopeNode *node = rope->root;
+    if (node == NULL || index >= node->length) {
+        return '\0';
+    }
+
+    while (!rope_is_leaf(node)) {
+        if (index < node->left->length) {
+            node = node->left;
+        } else {
+            index -= node->left->length;
+            node = node->right;
+        }
+    }
+    return node->bytes[index];
+}
+
+ArenaError rope_insert(Rope *rope, size_t pos, StringView text)
+{
+    if (text.len == 0) {
+        return ARENA_SUCCESS;
+    }
+
+    RopeBuilder builder = rope_builder(rope);
+    ChunkArenaMark mark = chunk_arena_mark(rope->arena);
+
+    char *bytes = chunk_arena_allocate(rope->arena, text.len, alignof(char));
+    if (bytes == NULL) {
+        return ARENA_ERROR_ALLOCATION_FAILED;
+    }
+    memcpy(bytes, text.ptr, text.len);
+
+    RopeNode *before, *after;
+    rope_split(&builder, rope->root, pos, &before, &after);
+    RopeNode *middle = rope_build(&builder, bytes, text.len);
+    RopeNode *root = rope_join(&builder, rope_join(&builder, before, middle), after);
+
+    if (builder.failed) {
+        // Nothing references the partial result, give its memory back
+        chunk_arena_restore(rope->arena, mark);
+        return ARENA_ERROR_ALLOCATION_FAILED;
+    }
+    rope->root = root;
+    return ARENA_SUCCESS;
+}
+
+ArenaError rope_append(Rope *rope, StringView text)
+{
+    return rope_insert(rope, rope_length(rope), text);
+}
+
+ArenaError rope_erase(Rope *rope, size_t pos, size_t length)
+{
+    size_t total = rope_length(rope);
+    if (pos >= total || length == 0) {
+        return ARENA_SUCCESS;
+    }
+    if (length > total - pos) {
+        length = total - pos;
+    }
+
+    RopeBuilder builder = rope_builder(rope);
+    ChunkArenaMark mark = chunk_arena_mark(rope->arena);
+
+    RopeNode *before, *rest, *removed, *after;
+    rope_split(&builder, rope->root, pos, &before, &rest);
+    rope_split(&builder, rest, length, &removed, &after);
+    RopeNode *root = rope_join(&builder, before, after);
+
+    if (builder.failed) {
+        chunk_arena_restore(rope->arena, mark);
+        return ARENA_ERROR_ALLOCATION_FAILED;
+    }
+    rope->root = root;
+    return ARENA_SUCCESS;
+}
+
+ArenaError rope_substring(const Rope *rope, size_t pos, size_t length, Rope *out)
+{
+    RopeBuilder builder = rope_builder(rope);
+    ChunkArenaMark mark = chunk_arena_mark(rope->arena);
+
+    RopeNode *before, *rest, *middle, *after;
+    rope_split(&builder, rope->root, pos, &before, &rest);
+    rope_split(&builder, rest, length, &middle, &after);
+
+    if (builder.failed) {
+        chunk_arena_restore(rope->arena, mark);
+        return ARENA_ERROR_ALLOCATION_FAILED;
+    }
+    out->root = middle;
+    out->arena = rope->arena;
+    return ARENA_SUCCESS;
+}
+
+void rope_chunks_begin(const Rope *rope, RopeChunkIterator *it)
+{
+    it->depth = 0;
+    if (rope->root) {
+        it->stack[it->depth++] = rope->root;
+    }
+}
+
+bool rope_chunks_next(RopeChunkIterator *it, StringView *chunk)
+{
+    if (it->depth == 0) {
+        return false;
+    }
+
+    // Walk down the left spine, remembering the right subtrees for later
+    const RopeNode *node = it->stack[--it->depth];
+    while (!rope_is_leaf(node)) {
+        it->stack[it->depth++] = node->right;
+        node = node->left;
+    }
+
+    *chunk = string_view_from_bytes(node->bytes, node->length);
+    return true;
+}
+
+ArenaError rope_append_to_string_arena(const Rope *rope, String *dest, Arena *arena)
+{
+    size_t length = rope_length(rope);
+    ArenaError grow_result = string_grow_arena(dest, dest->length + length + 1, arena);
+    if (grow_result != ARENA_SUCCESS) {
+        return grow_result;
+    }
+
+    RopeChunkIterator it;
+    StringView chunk;
+    char *out = dest->data + dest->length;
+    rope_chunks_begin(rope, &it);
+    while (rope_chunks_next(&it, &chunk)) {
+        memcpy(out, chunk.ptr, chunk.len);
+        out += chunk.len;
+    }
+
+    dest->length += length;
+    dest->data[dest->length] = '\0';
+    dest->hash = 0;
+    return ARENA_SUCCESS;
+}
+
+ArenaError rope_append_to_string_malloc(const Rope *rope, String *dest)
+{
+    return rope_append_to_string_arena(rope, dest, NULL);
+}
+
+String *rope_to_string_malloc(const Rope *rope)
+{
+    String *string = new_string_malloc(NULL);
+    if (string == NULL) {
+        return NULL;
+    }
+    if (string_reserve_malloc(string, rope_length(rope)) != ARENA_SUCCESS ||
+        rope_append_to_string_malloc(rope, string) != ARENA_SUCCESS) {
+        string_free(string);
+        return NULL;
+    }
+    return string;
+}
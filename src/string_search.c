@@ -0,0 +1,401 @@
+// Searching in `String` and `StringView`.
+//
+// All functions work on the stored length, so they never scan for a null terminator and handle
+// embedded null bytes. Substring searches use the first/last byte filter: a block of candidate
+// positions is checked at once by comparing the first needle byte at every position and the last
+// needle byte at every position + needle length - 1. Only positions where both match are verified.
+
+#include "c_string.h"
+#include "c_string_simd.h"
+#include <string.h>
+
+// Up to this many bytes in a set are compared with vector instructions, larger sets use a table
+#define STRING_SEARCH_SIMD_SET_MAX 8
+
+// Lookup table with one bit per byte value
+typedef struct
+{
+    uint32_t bits[8];
+} ByteSet;
+
+static void byte_set_init(ByteSet *set, StringView bytes)
+{
+    memset(set->bits, 0, sizeof(set->bits));
+    for (size_t i = 0; i < bytes.len; i++) {
+        unsigned char c = (unsigned char)bytes.ptr[i];
+        set->bits[c >> 5] |= 1u << (c & 31);
+    }
+}
+
+static bool byte_set_contains(const ByteSet *set, char c)
+{
+    unsigned char u = (unsigned char)c;
+    return (set->bits[u >> 5] >> (u & 31)) & 1u;
+}
+
+// Scalar substring search, used for the tail of the vector loops and on targets without SIMD.
+static size_t find_scalar(const char *haystack, size_t len, const char *needle, size_t needle_len, size_t start)
+{
+    size_t last = len - needle_len;
+    size_t pos = start;
+    while (pos <= last) {
+        const char *found = memchr(haystack + pos, needle[0], last - pos + 1);
+        if (!found) {
+            return STRING_NPOS;
+        }
+        pos = (size_t)(found - haystack);
+        if (haystack[pos + needle_len - 1] == needle[needle_len - 1] &&
+            memcmp(found + 1, needle + 1, needle_len - 2) == 0) {
+            return pos;
+        }
+        pos++;
+    }
+    return STRING_NPOS;
+}
+
+#if defined(C_STRING_HAVE_SSE2)
+static size_t find_sse2(const char *haystack, size_t len, const char *needle, size_t needle_len, size_t start)
+{
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[needle_len - 1]);
+    size_t pos = start;
+
+    // Candidate positions pos..pos+15 need bytes up to pos + 15 + needle_len - 1
+    while (pos + 16 + needle_len - 1 <= len) {
+        __m128i block_first = _mm_loadu_si128((const __m128i *)(haystack + pos));
+        __m128i block_last = _mm_loadu_si128((const __m128i *)(haystack + pos + needle_len - 1));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last)));
+
+        while (mask) {
+            unsigned bit = cs_ctz32(mask);
+            if (memcmp(haystack + pos + bit + 1, needle + 1, needle_len - 2) == 0) {
+                return pos + bit;
+            }
+            mask &= mask - 1;
+        }
+        pos += 16;
+    }
+
+    return pos + needle_len <= len ? find_scalar(haystack, len, needle, needle_len, pos) : STRING_NPOS;
+}
+#endif
+
+#if defined(C_STRING_HAVE_AVX2_DISPATCH)
+C_STRING_TARGET_AVX2
+static size_t find_avx2(const char *haystack, size_t len, const char *needle, size_t needle_len, size_t start)
+{
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[needle_len - 1]);
+    size_t pos = start;
+
+    while (pos + 32 + needle_len - 1 <= len) {
+        __m256i block_first = _mm256_loadu_si256((const __m256i *)(haystack + pos));
+        __m256i block_last = _mm256_loadu_si256((const __m256i *)(haystack + pos + needle_len - 1));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(block_first, first), _mm256_cmpeq_epi8(block_last, last)));
+
+        while (mask) {
+            unsigned bit = cs_ctz32(mask);
+            if (memcmp(haystack + pos + bit + 1, needle + 1, needle_len - 2) == 0) {
+                return pos + bit;
+            }
+            mask &= mask - 1;
+        }
+        pos += 32;
+    }
+
+    return pos + needle_len <= len ? find_sse2(haystack, len, needle, needle_len, pos) : STRING_NPOS;
+}
+#endif
+
+// Scalar reverse substring search, candidates are pos..0
+static size_t rfind_scalar(const char *haystack, const char *needle, size_t needle_len, size_t pos)
+{
+    for (;;) {
+        if (haystack[pos] == needle[0] && haystack[pos + needle_len - 1] == needle[needle_len - 1] &&
+            memcmp(haystack + pos + 1, needle + 1, needle_len - 2) == 0) {
+            return pos;
+        }
+        if (pos == 0) {
+            return STRING_NPOS;
+        }
+        pos--;
+    }
+}
+
+#if defined(C_STRING_HAVE_SSE2)
+static size_t rfind_sse2(const char *haystack, const char *needle, size_t needle_len, size_t pos)
+{
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[needle_len - 1]);
+
+    // Check the candidates base..base+15 where base + 15 == pos, walking towards the front
+    while (pos >= 15) {
+        size_t base = pos - 15;
+        __m128i block_first = _mm_loadu_si128((const __m128i *)(haystack + base));
+        __m128i block_last = _mm_loadu_si128((const __m128i *)(haystack + base + needle_len - 1));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last)));
+
+        while (mask) {
+            unsigned bit = cs_msb32(mask);
+            if (memcmp(haystack + base + bit + 1, needle + 1, needle_len - 2) == 0) {
+                return base + bit;
+            }
+            mask &= ~(1u << bit);
+        }
+        if (base == 0) {
+            return STRING_NPOS;
+        }
+        pos = base - 1;
+    }
+
+    return rfind_scalar(haystack, needle, needle_len, pos);
+}
+#endif
+
+size_t string_view_find_char(StringView view, char c, size_t start)
+{
+    if (start >= view.len) {
+        return STRING_NPOS;
+    }
+
+    // memchr already is a vectorized, runtime dispatched scan in every mainstream C library
+    const char *found = memchr(view.ptr + start, c, view.len - start);
+    return found ? (size_t)(found - view.ptr) : STRING_NPOS;
+}
+
+size_t string_view_rfind_char(StringView view, char c, size_t start)
+{
+    if (view.len == 0) {
+        return STRING_NPOS;
+    }
+    size_t pos = start < view.len ? start : view.len - 1;
+
+#if defined(C_STRING_HAVE_SSE2)
+    const __m128i target = _mm_set1_epi8(c);
+    while (pos >= 15) {
+        size_t base = pos - 15;
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(
+            _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(view.ptr + base)), target));
+        if (mask) {
+            return base + cs_msb32(mask);
+        }
+        if (base == 0) {
+            return STRING_NPOS;
+        }
+        pos = base - 1;
+    }
+#endif
+
+    for (;;) {
+        if (view.ptr[pos] == c) {
+            return pos;
+        }
+        if (pos == 0) {
+            return STRING_NPOS;
+        }
+        pos--;
+    }
+}
+
+size_t string_view_find(StringView view, StringView needle, size_t start)
+{
+    if (start > view.len || needle.len > view.len - start) {
+        return STRING_NPOS;
+    }
+    if (needle.len == 0) {
+        return start;
+    }
+    if (needle.len == 1) {
+        return string_view_find_char(view, needle.ptr[0], start);
+    }
+
+#if defined(C_STRING_HAVE_AVX2_DISPATCH)
+    if (cs_cpu_has_avx2()) {
+        return find_avx2(view.ptr, view.len, needle.ptr, needle.len, start);
+    }
+#endif
+#if defined(C_STRING_HAVE_SSE2)
+    return find_sse2(view.ptr, view.len, needle.ptr, needle.len, start);
+#else
+    return find_scalar(view.ptr, view.len, needle.ptr, needle.len, start);
+#endif
+}
+
+size_t string_view_rfind(StringView view, StringView needle, size_t start)
+{
+    if (needle.len > view.len) {
+        return STRING_NPOS;
+    }
+    size_t pos = view.len - needle.len;
+    if (start < pos) {
+        pos = start;
+    }
+    if (needle.len == 0) {
+        return pos;
+    }
+    if (needle.len == 1) {
+        return string_view_rfind_char(view, needle.ptr[0], pos);
+    }
+
+#if defined(C_STRING_HAVE_SSE2)
+    return rfind_sse2(view.ptr, needle.ptr, needle.len, pos);
+#else
+    return rfind_scalar(view.ptr, needle.ptr, needle.len, pos);
+#endif
+}
+
+// Finds the first byte at or after start that is (or with negate, is not) in set
+static size_t find_first_in_set(StringView view, StringView set, size_t start, bool negate)
+{
+    if (start >= view.len) {
+        return STRING_NPOS;
+    }
+    size_t pos = start;
+
+#if defined(C_STRING_HAVE_SSE2)
+    if (set.len > 0 && set.len <= STRING_SEARCH_SIMD_SET_MAX) {
+        __m128i targets[STRING_SEARCH_SIMD_SET_MAX];
+        for (size_t i = 0; i < set.len; i++) {
+            targets[i] = _mm_set1_epi8(set.ptr[i]);
+        }
+
+        while (pos + 16 <= view.len) {
+            __m128i block = _mm_loadu_si128((const __m128i *)(view.ptr + pos));
+            __m128i hits = _mm_cmpeq_epi8(block, targets[0]);
+            for (size_t i = 1; i < set.len; i++) {
+                hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, targets[i]));
+            }
+            uint32_t mask = (uint32_t)_mm_movemask_epi8(hits);
+            if (negate) {
+                mask ^= 0xFFFFu;
+            }
+            if (mask) {
+                return pos + cs_ctz32(mask);
+            }
+            pos += 16;
+        }
+    }
+#endif
+
+    ByteSet bytes;
+    byte_set_init(&bytes, set);
+    for (; pos < view.len; pos++) {
+        if (byte_set_contains(&bytes, view.ptr[pos]) != negate) {
+            return pos;
+        }
+    }
+    return STRING_NPOS;
+}
+
+// Finds the last byte at or before start that is (or with negate, is not) in set
+static size_t find_last_in_set(StringView view, StringView set, size_t start, bool negate)
+{
+    if (view.len == 0) {
+        return STRING_NPOS;
+    }
+    size_t pos = start < view.len ? start : view.len - 1;
+
+#if defined(C_STRING_HAVE_SSE2)
+    if (set.len > 0 && set.len <= STRING_SEARCH_SIMD_SET_MAX) {
+        __m128i targets[STRING_SEARCH_SIMD_SET_MAX];
+        for (size_t i = 0; i < set.len; i++) {
+            targets[i] = _mm_set1_epi8(set.ptr[i]);
+        }
+
+        while (pos >= 15) {
+            size_t base = pos - 15;
+            __m128i block = _mm_loadu_si128((const __m128i *)(view.ptr + base));
+            __m128i hits = _mm_cmpeq_epi8(block, targets[0]);
+            for (size_t i = 1; i < set.len; i++) {
+                hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, targets[i]));
+            }
+            uint32_t mask = (uint32_t)_mm_movemask_epi8(hits);
+            if (negate) {
+                mask ^= 0xFFFFu;
+            }
+            if (mask) {
+                return base + cs_msb32(mask);
+            }
+            if (base == 0) {
+                return STRING_NPOS;
+            }
+            pos = base - 1;
+        }
+    }
+#endif
+
+    ByteSet bytes;
+    byte_set_init(&bytes, set);
+    for (;;) {
+        if (byte_set_contains(&bytes, view.ptr[pos]) != negate) {
+            return pos;
+        }
+        if (pos == 0) {
+            return STRING_NPOS;
+        }
+        pos--;
+    }
+}
+
+size_t string_view_find_first_of(StringView view, StringView set, size_t start)
+{
+    return find_first_in_set(view, set, start, false);
+}
+
+size_t string_view_find_first_not_of(StringView view, StringView set, size_t start)
+{
+    return find_first_in_set(view, set, start, true);
+}
+
+size_t string_view_find_last_of(StringView view, StringView set, size_t start)
+{
+    return find_last_in_set(view, set, start, false);
+}
+
+size_t string_view_find_last_not_of(StringView view, StringView set, size_t start)
+{
+    return find_last_in_set(view, set, start, true);
+}
+
+size_t string_find(const String *string, StringView needle, size_t start)
+{
+    return string_view_find(string_view_from_string(string), needle, start);
+}
+
+size_t string_rfind(const String *string, StringView needle, size_t start)
+{
+    return string_view_rfind(string_view_from_string(string), needle, start);
+}
+
+size_t string_find_char(const String *string, char c, size_t start)
+{
+    return string_view_find_char(string_view_from_string(string), c, start);
+}
+
+size_t string_rfind_char(const String *string, char c, size_t start)
+{
+    return string_view_rfind_char(string_view_from_string(string), c, start);
+}
+
+size_t string_find_first_of(const String *string, StringView set, size_t start)
+{
+    return string_view_find_first_of(string_view_from_string(string), set, start);
+}
+
+size_t string_find_first_not_of(const String *string, StringView set, size_t start)
+{
+    return string_view_find_first_not_of(string_view_from_string(string), set, start);
+}
+
+size_t string_find_last_of(const String *string, StringView set, size_t start)
+{
+    return string_view_find_last_of(string_view_from_string(string), set, start);
+}
+
+size_t string_find_last_not_of(const String *string, StringView set, size_t start)
+{
+    return string_view_find_last_not_of(string_view_from_string(string), set, start);
+}
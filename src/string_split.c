@@ -0,0 +1,127 @@
+// Splitting `StringView`s into tokens without allocating.
+
+#include "c_string.h"
+#include "c_string_simd.h"
+#include <string.h>
+
+static StringSplitIterator string_split_make(StringView input, StringSplitMode mode, StringView delimiter, char delimiter_char)
+{
+    StringSplitIterator it;
+    it.rest = input;
+    it.delimiter = delimiter;
+    it.delimiter_char = delimiter_char;
+    it.mode = mode;
+    it.done = false;
+    return it;
+}
+
+StringSplitIterator string_split_char(StringView input, char delimiter)
+{
+    return string_split_make(input, STRING_SPLIT_CHAR, string_view_from_bytes(NULL, 0), delimiter);
+}
+
+StringSplitIterator string_split_any(StringView input, StringView delimiters)
+{
+    return string_split_make(input, STRING_SPLIT_ANY, delimiters, '\0');
+}
+
+StringSplitIterator string_split_substring(StringView input, StringView delimiter)
+{
+    return string_split_make(input, STRING_SPLIT_SUBSTRING, delimiter, '\0');
+}
+
+bool string_split_next(StringSplitIterator *it, StringView *token)
+{
+    if (it->done) {
+        return false;
+    }
+
+    size_t pos = STRING_NPOS;
+    size_t skip = 1;
+    switch (it->mode) {
+    case STRING_SPLIT_CHAR:
+        pos = string_view_find_char(it->rest, it->delimiter_char, 0);
+        break;
+    case STRING_SPLIT_ANY:
+        pos = string_view_find_first_of(it->rest, it->delimiter, 0);
+        break;
+    case STRING_SPLIT_SUBSTRING:
+        // An empty delimiter would match everywhere, the whole input is one token then
+        pos = it->delimiter.len ? string_view_find(it->rest, it->delimiter, 0) : STRING_NPOS;
+        skip = it->delimiter.len;
+        break;
+    }
+
+    if (pos == STRING_NPOS) {
+        // The last token is whatever is left, even if it is empty
+        *token = it->rest;
+        it->rest = string_view_slice(it->rest, it->rest.len, 0);
+        it->done = true;
+        return true;
+    }
+
+    *token = string_view_slice(it->rest, 0, pos);
+    it->rest = string_view_slice(it->rest, pos + skip, STRING_NPOS);
+    return true;
+}
+
+#if defined(C_STRING_HAVE_AVX2_DISPATCH)
+C_STRING_TARGET_AVX2
+static size_t split_offsets_avx2(StringView input, char delimiter, size_t *pos, size_t *offsets, size_t max_offsets)
+{
+    const __m256i target = _mm256_set1_epi8(delimiter);
+    size_t count = 0;
+    size_t i = *pos;
+
+    while (i + 32 <= input.len) {
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(input.ptr + i)), target));
+        while (mask) {
+            if (count == max_offsets) {
+                return count;
+            }
+            offsets[count++] = i + cs_ctz32(mask);
+            mask &= mask - 1;
+        }
+        i += 32;
+    }
+
+    *pos = i;
+    return count;
+}
+#endif
+
+size_t string_split_offsets(StringView input, char delimiter, size_t start, size_t *offsets, size_t max_offsets)
+{
+    size_t count = 0;
+    size_t i = start;
+
+#if defined(C_STRING_HAVE_AVX2_DISPATCH)
+    if (cs_cpu_has_avx2()) {
+        count = split_offsets_avx2(input, delimiter, &i, offsets, max_offsets);
+    }
+#endif
+
+#if defined(C_STRING_HAVE_SSE2)
+    const __m128i target = _mm_set1_epi8(delimiter);
+    while (count < max_offsets && i + 16 <= input.len) {
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(
+            _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(input.ptr + i)), target));
+        while (mask) {
+            if (count == max_offsets) {
+                return count;
+            }
+            offsets[count++] = i + cs_ctz32(mask);
+            mask &= mask - 1;
+        }
+        i += 16;
+    }
+#endif
+
+    for (; count < max_offsets && i < input.len; i++) {
+        if (input.ptr[i] == delimiter) {
+            offsets[count++] = i;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,253 @@
+// Conversion of Latin-1 and UTF-16 input into UTF-8 Strings.
+//
+// Every conversion runs twice over the input: once to compute the exact output size, so the
+// destination grows once, and once to write. Both passes skip ASCII runs with SSE2.
+
+#include "c_string.h"
+#include "c_string_internal.h"
+#include "c_string_simd.h"
+#include <string.h>
+
+#define UTF16_HIGH_SURROGATE(u) ((u) >= 0xD800 && (u) <= 0xDBFF)
+#define UTF16_LOW_SURROGATE(u) ((u) >= 0xDC00 && (u) <= 0xDFFF)
+
+// Writes the UTF-8 encoding of code_point to out, or only measures it if out is NULL
+static inline size_t utf8_encode(uint32_t code_point, char *out)
+{
+    if (code_point < 0x80) {
+        if (out) {
+            out[0] = (char)code_point;
+        }
+        return 1;
+    }
+    if (code_point < 0x800) {
+        if (out) {
+            out[0] = (char)(0xC0 | (code_point >> 6));
+            out[1] = (char)(0x80 | (code_point & 0x3F));
+        }
+        return 2;
+    }
+    if (code_point < 0x10000) {
+        if (out) {
+            out[0] = (char)(0xE0 | (code_point >> 12));
+            out[1] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+            out[2] = (char)(0x80 | (code_point & 0x3F));
+        }
+        return 3;
+    }
+    if (out) {
+        out[0] = (char)(0xF0 | (code_point >> 18));
+        out[1] = (char)(0x80 | ((code_point >> 12) & 0x3F));
+        out[2] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+        out[3] = (char)(0x80 | (code_point & 0x3F));
+    }
+    return 4;
+}
+
+// Grows dest for length more bytes. The caller writes them and then calls string_transcode_end.
+// If *src points into dest it is moved along with the data.
+static char *string_transcode_begin(String *dest, size_t length, const void **src, Arena *arena, ArenaError *error)
+{
+    size_t src_offset = 0;
+    bool aliased = src != NULL && string_contains_pointer(dest, *src, &src_offset);
+
+    *error = string_grow_arena(dest, dest->length + length + 1, arena);
+    if (*error != ARENA_SUCCESS) {
+        return NULL;
+    }
+    if (aliased) {
+        *src = dest->data + src_offset;
+    }
+    return dest->data + dest->length;
+}
+
+static void string_transcode_end(String *dest, size_t length)
+{
+    dest->length += length;
+    dest->data[dest->length] = '\0';
+    dest->hash = 0;
+}
+
+// Latin-1 maps byte b to code point b, bytes from 0x80 take two UTF-8 bytes
+static size_t latin1_measure(const unsigned char *src, size_t len)
+{
+    size_t length = len;
+    size_t i = 0;
+
+#ifdef C_STRING_HAVE_SSE2
+    for (; i + 16 <= len; i += 16) {
+        length += cs_popcount32((uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(src + i))));
+    }
+#endif
+
+    for (; i < len; i++) {
+        length += src[i] >> 7;
+    }
+    return length;
+}
+
+static void latin1_convert(const unsigned char *src, size_t len, char *out)
+{
+    size_t i = 0;
+    while (i < len) {
+#ifdef C_STRING_HAVE_SSE2
+        if (i + 16 <= len) {
+            __m128i bytes = _mm_loadu_si128((const __m128i *)(src + i));
+            if (_mm_movemask_epi8(bytes) == 0) {
+                _mm_storeu_si128((__m128i *)out, bytes);
+                out += 16;
+                i += 16;
+                continue;
+            }
+        }
+#endif
+        out += utf8_encode(src[i], out);
+        i++;
+    }
+}
+
+ArenaError string_append_latin1_arena(String *dest, const char *src, size_t len, Arena *arena)
+{
+    size_t length = latin1_measure((const unsigned char *)src, len);
+
+    ArenaError error;
+    const void *source = src;
+    char *out = string_transcode_begin(dest, length, &source, arena, &error);
+    if (out == NULL) {
+        return error;
+    }
+    latin1_convert(source, len, out);
+    string_transcode_end(dest, length);
+    return ARENA_SUCCESS;
+}
+
+ArenaError string_append_latin1_malloc(String *dest, const char *src, size_t len)
+{
+    return string_append_latin1_arena(dest, src, len, NULL);
+}
+
+// Converts UTF-16 to UTF-8, or only measures the output if out is NULL. pending is a high
+// surrogate left over from the previous buffer. If streaming, a high surrogate at the end is
+// returned in *next_pending instead of being replaced with U+FFFD.
+static size_t utf16_transcode(const uint16_t *src, size_t len, uint16_t pending, bool streaming,
+                              char *out, uint16_t *next_pending)
+{
+    size_t written = 0;
+    size_t i = 0;
+
+    if (pending && len > 0) {
+        if (UTF16_LOW_SURROGATE(src[0])) {
+            uint32_t code_point = 0x10000 + (((uint32_t)pending - 0xD800) << 10) + (src[0] - 0xDC00);
+            written += utf8_encode(code_point, out ? out + written : NULL);
+            i = 1;
+        } else {
+            written += utf8_encode(STRING_UTF8_REPLACEMENT, out ? out + written : NULL);
+        }
+        pending = 0;
+    }
+
+    while (i < len) {
+#ifdef C_STRING_HAVE_SSE2
+        if (i + 8 <= len) {
+            // Eight code units below 0x80 become eight bytes
+            __m128i units = _mm_loadu_si128((const __m128i *)(src + i));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(units, _mm_set1_epi16((short)0xFF80)),
+                                                  _mm_setzero_si128())) == 0xFFFF) {
+                if (out) {
+                    _mm_storel_epi64((__m128i *)(out + written), _mm_packus_epi16(units, units));
+                }
+                written += 8;
+                i += 8;
+                continue;
+            }
+        }
+#endif
+        uint16_t unit = src[i++];
+        uint32_t code_point = unit;
+
+        if (UTF16_HIGH_SURROGATE(unit)) {
+            if (i < len && UTF16_LOW_SURROGATE(src[i])) {
+                code_point = 0x10000 + (((uint32_t)unit - 0xD800) << 10) + (src[i] - 0xDC00);
+                i++;
+            } else if (i == len && streaming) {
+                // The low surrogate may arrive with the next buffer
+                pending = unit;
+                break;
+            } else {
+                code_point = STRING_UTF8_REPLACEMENT;
+            }
+        } else if (UTF16_LOW_SURROGATE(unit)) {
+            code_point = STRING_UTF8_REPLACEMENT;
+        }
+        written += utf8_encode(code_point, out ? out + written : NULL);
+    }
+
+    *next_pending = pending;
+    return written;
+}
+
+// Shared implementation of the one-shot and the streaming UTF-16 appends
+static ArenaError string_append_utf16_state(String *dest, const uint16_t *src, size_t len, uint16_t *pending,
+                                            bool streaming, Arena *arena)
+{
+    uint16_t next_pending;
+    size_t length = utf16_transcode(src, len, *pending, streaming, NULL, &next_pending);
+
+    ArenaError error;
+    const void *source = src;
+    char *out = string_transcode_begin(dest, length, &source, arena, &error);
+    if (out == NULL) {
+        return error;
+    }
+    utf16_transcode(source, len, *pending, streaming, out, &next_pending);
+    string_transcode_end(dest, length);
+    *pending = next_pending;
+    return ARENA_SUCCESS;
+}
+
+ArenaError string_append_utf16_arena(String *dest, const uint16_t *src, size_t len, Arena *arena)
+{
+    uint16_t pending = 0;
+    return string_append_utf16_state(dest, src, len, &pending, false, arena);
+}
+
+ArenaError string_append_utf16_malloc(String *dest, const uint16_t *src, size_t len)
+{
+    return string_append_utf16_arena(dest, src, len, NULL);
+}
+
+void string_utf16_decoder_init(StringUtf16Decoder *decoder)
+{
+    decoder->pending = 0;
+}
+
+ArenaError string_utf16_decoder_append_arena(StringUtf16Decoder *decoder, String *dest, const uint16_t *src, size_t len, Arena *arena)
+{
+    return string_append_utf16_state(dest, src, len, &decoder->pending, true, arena);
+}
+
+ArenaError string_utf16_decoder_append_malloc(StringUtf16Decoder *decoder, String *dest, const uint16_t *src, size_t len)
+{
+    return string_utf16_decoder_append_arena(decoder, dest, src, len, NULL);
+}
+
+ArenaError string_utf16_decoder_finish_arena(StringUtf16Decoder *decoder, String *dest, Arena *arena)
+{
+    if (decoder->pending == 0) {
+        return ARENA_SUCCESS;
+    }
+
+    ArenaError error;
+    char *out = string_transcode_begin(dest, 3, NULL, arena, &error);
+    if (out == NULL) {
+        return error;
+    }
+    string_transcode_end(dest, utf8_encode(STRING_UTF8_REPLACEMENT, out));
+    decoder->pending = 0;
+    return ARENA_SUCCESS;
+}
+
+ArenaError string_utf16_decoder_finish_malloc(StringUtf16Decoder *decoder, String *dest)
+{
+    return string_utf16_decoder_finish_arena(decoder, dest, NULL);
+}
@@ -0,0 +1,96 @@
+// Trimming, stripping and squeezing Strings in place. The scanning is done by the view
+// functions, which use the vectorized set search for long runs.
+
+#include "c_string.h"
+#include <string.h>
+
+StringView string_view_strip_left(StringView view, StringView set)
+{
+    size_t start = string_view_find_first_not_of(view, set, 0);
+    return string_view_slice(view, start, STRING_NPOS);
+}
+
+StringView string_view_strip_right(StringView view, StringView set)
+{
+    size_t last = string_view_find_last_not_of(view, set, STRING_NPOS);
+    return string_view_slice(view, 0, last == STRING_NPOS ? 0 : last + 1);
+}
+
+StringView string_view_strip(StringView view, StringView set)
+{
+    return string_view_strip_right(string_view_strip_left(view, set), set);
+}
+
+// Makes kept, a view into string, the new content of string
+static void string_keep(String *string, StringView kept)
+{
+    if (kept.len == string->length) {
+        return;
+    }
+
+    if (kept.ptr != string->data) {
+        memmove(string->data, kept.ptr, kept.len);
+    }
+    string->length = kept.len;
+    string->data[kept.len] = '\0';
+    string->hash = 0;
+}
+
+void string_trim(String *string)
+{
+    string_keep(string, string_view_trim(string_view_from_string(string)));
+}
+
+void string_trim_left(String *string)
+{
+    string_keep(string, string_view_trim_left(string_view_from_string(string)));
+}
+
+void string_trim_right(String *string)
+{
+    string_keep(string, string_view_trim_right(string_view_from_string(string)));
+}
+
+void string_strip(String *string, StringView set)
+{
+    string_keep(string, string_view_strip(string_view_from_string(string), set));
+}
+
+void string_strip_left(String *string, StringView set)
+{
+    string_keep(string, string_view_strip_left(string_view_from_string(string), set));
+}
+
+void string_strip_right(String *string, StringView set)
+{
+    string_keep(string, string_view_strip_right(string_view_from_string(string), set));
+}
+
+void string_squeeze(String *string, StringView set)
+{
+    StringView view = string_view_from_string(string);
+    size_t read = string_view_find_first_of(view, set, 0);
+    if (read == STRING_NPOS) {
+        return;
+    }
+
+    // Everything before the first run stays where it is. Writes never overtake reads, so the
+    // searches always see original bytes.
+    size_t write = read;
+    while (read != STRING_NPOS) {
+        string->data[write++] = string->data[read];
+        size_t next = string_view_find_first_not_of(view, set, read + 1);
+        if (next == STRING_NPOS) {
+            break;
+        }
+        size_t run_end = string_view_find_first_of(view, set, next);
+        size_t keep = (run_end == STRING_NPOS ? view.len : run_end) - next;
+        memmove(string->data + write, string->data + next, keep);
+        write += keep;
+        read = run_end;
+    }
+
+    string->length = write;
+    string->data[write] = '\0';
+    string->hash = 0;
+}
@@ -0,0 +1,284 @@
+// UTF-8 validation, counting and decoding.
+//
+// The scalar decoder follows table 3-7 of the Unicode standard. The AVX2 validator is the
+// lookup algorithm from "Validating UTF-8 In Less Than One Instruction Per Byte" (Keiser,
+// Lemire): three nibble lookups classify every pair of adjacent bytes, two more checks cover
+// the third and fourth byte of long sequences.
+
+#include "c_string.h"
+#include "c_string_simd.h"
+#include <string.h>
+
+// Decodes the sequence at the start of p. Returns its length, or 0 if it is invalid, in which
+// case *valid_prefix receives the length of its longest valid prefix (at least 1).
+static size_t utf8_decode(const unsigned char *p, size_t len, uint32_t *code_point, size_t *valid_prefix)
+{
+    unsigned char lead = p[0];
+    *valid_prefix = 1;
+
+    if (lead < 0x80) {
+        *code_point = lead;
+        return 1;
+    }
+
+    size_t need;
+    uint32_t value;
+    unsigned char low = 0x80, high = 0xBF; // Allowed range of the second byte
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        need = 2;
+        value = lead & 0x1F;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        need = 3;
+        value = lead & 0x0F;
+        if (lead == 0xE0) {
+            low = 0xA0; // Overlong
+        } else if (lead == 0xED) {
+            high = 0x9F; // Surrogates
+        }
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        need = 4;
+        value = lead & 0x07;
+        if (lead == 0xF0) {
+            low = 0x90; // Overlong
+        } else if (lead == 0xF4) {
+            high = 0x8F; // Above U+10FFFF
+        }
+    } else {
+        return 0;
+    }
+
+    for (size_t i = 1; i < need; i++) {
+        if (i >= len || p[i] < low || p[i] > high) {
+            return 0;
+        }
+        value = (value << 6) | (p[i] & 0x3F);
+        *valid_prefix = i + 1;
+        low = 0x80;
+        high = 0xBF;
+    }
+
+    *code_point = value;
+    return need;
+}
+
+#ifdef C_STRING_HAVE_SSE2
+static inline bool is_ascii_sse2(const unsigned char *p)
+{
+    return _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)p)) == 0;
+}
+#endif
+
+static bool utf8_validate_scalar(const unsigned char *p, size_t len)
+{
+    size_t i = 0;
+    while (i < len) {
+#ifdef C_STRING_HAVE_SSE2
+        if (i + 16 <= len && is_ascii_sse2(p + i)) {
+            i += 16;
+            continue;
+        }
+#endif
+        uint32_t code_point;
+        size_t prefix;
+        size_t n = utf8_decode(p + i, len - i, &code_point, &prefix);
+        if (n == 0) {
+            return false;
+        }
+        i += n;
+    }
+    return true;
+}
+
+#if defined(C_STRING_HAVE_AVX2_DISPATCH)
+
+// Error classes, a pair of bytes is invalid if all three lookups agree on one class
+#define UTF8_TOO_SHORT (1 << 0)      // Lead byte not followed by a continuation
+#define UTF8_TOO_LONG (1 << 1)       // ASCII followed by a continuation
+#define UTF8_OVERLONG_3 (1 << 2)     // E0 followed by 80..9F
+#define UTF8_TOO_LARGE (1 << 3)      // F4 followed by 90..BF, or F5..FF
+#define UTF8_SURROGATE (1 << 4)      // ED followed by A0..BF
+#define UTF8_OVERLONG_2 (1 << 5)     // C0 or C1
+#define UTF8_TOO_LARGE_1000 (1 << 6) // F5..FF followed by 80..8F
+#define UTF8_OVERLONG_4 (1 << 6)     // F0 followed by 80..8F
+#define UTF8_TWO_CONTS (-128)        // 1 << 7 as a signed byte: two continuations, fine inside a longer sequence
+#define UTF8_CARRY (UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS)
+
+#define UTF8_TABLE(...) _mm256_setr_epi8(__VA_ARGS__, __VA_ARGS__)
+
+// The bytes of input shifted by n positions, with the last bytes of prev shifted in
+#define UTF8_PREV(input, prev, n) _mm256_alignr_epi8((input), _mm256_permute2x128_si256((prev), (input), 0x21), 16 - (n))
+
+C_STRING_TARGET_AVX2
+static inline __m256i utf8_high_nibbles(__m256i bytes)
+{
+    return _mm256_and_si256(_mm256_srli_epi16(bytes, 4), _mm256_set1_epi8(0x0F));
+}
+
+C_STRING_TARGET_AVX2
+static inline __m256i utf8_check_block(__m256i input, __m256i prev_input)
+{
+    const __m256i byte_1_high_table = UTF8_TABLE(
+        UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+        UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+        UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS,
+        UTF8_TOO_SHORT | UTF8_OVERLONG_2,
+        UTF8_TOO_SHORT,
+        UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+        UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4);
+    const __m256i byte_1_low_table = UTF8_TABLE(
+        UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,
+        UTF8_CARRY | UTF8_OVERLONG_2,
+        UTF8_CARRY,
+        UTF8_CARRY,
+        UTF8_CARRY | UTF8_TOO_LARGE,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000);
+    const __m256i byte_2_high_table = UTF8_TABLE(
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT);
+
+    __m256i prev1 = UTF8_PREV(input, prev_input, 1);
+    __m256i byte_1_high = _mm256_shuffle_epi8(byte_1_high_table, utf8_high_nibbles(prev1));
+    __m256i byte_1_low = _mm256_shuffle_epi8(byte_1_low_table, _mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)));
+    __m256i byte_2_high = _mm256_shuffle_epi8(byte_2_high_table, utf8_high_nibbles(input));
+    __m256i special = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+    // Two continuations in a row are only allowed as the third or fourth byte of a sequence
+    __m256i prev2 = UTF8_PREV(input, prev_input, 2);
+    __m256i prev3 = UTF8_PREV(input, prev_input, 3);
+    __m256i third = _mm256_subs_epu8(prev2, _mm256_set1_epi8((char)(0xE0 - 1)));
+    __m256i fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8((char)(0xF0 - 1)));
+    __m256i must_be_continuation = _mm256_cmpgt_epi8(_mm256_or_si256(third, fourth), _mm256_setzero_si256());
+    __m256i expected = _mm256_and_si256(must_be_continuation, _mm256_set1_epi8((char)0x80));
+    return _mm256_xor_si256(expected, special);
+}
+
+// Non-zero if the block ends inside a sequence, which is an error if no continuation follows
+C_STRING_TARGET_AVX2
+static inline __m256i utf8_incomplete(__m256i input)
+{
+    const __m256i max_value = _mm256_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        (char)(0xF0 - 1), (char)(0xE0 - 1), (char)(0xC0 - 1));
+    return _mm256_subs_epu8(input, max_value);
+}
+
+C_STRING_TARGET_AVX2
+static bool utf8_validate_avx2(const unsigned char *p, size_t len)
+{
+    __m256i error = _mm256_setzero_si256();
+    __m256i prev_input = _mm256_setzero_si256();
+    __m256i prev_incomplete = _mm256_setzero_si256();
+    size_t i = 0;
+
+    for (;;) {
+        __m256i input;
+        if (i + 32 <= len) {
+            input = _mm256_loadu_si256((const __m256i *)(p + i));
+        } else if (i < len) {
+            // Pad the tail with zeros, which are ASCII and end any open sequence as an error
+            unsigned char tail[32] = { 0 };
+            memcpy(tail, p + i, len - i);
+            input = _mm256_loadu_si256((const __m256i *)tail);
+        } else {
+            break;
+        }
+
+        if (_mm256_movemask_epi8(input) == 0) {
+            // ASCII only, the previous block must not have ended inside a sequence
+            error = _mm256_or_si256(error, prev_incomplete);
+        } else {
+            error = _mm256_or_si256(error, utf8_check_block(input, prev_input));
+            prev_incomplete = utf8_incomplete(input);
+        }
+        prev_input = input;
+        i += 32;
+    }
+
+    error = _mm256_or_si256(error, prev_incomplete);
+    return _mm256_testz_si256(error, error) != 0;
+}
+
+#endif
+
+bool string_view_utf8_validate(StringView view)
+{
+    const unsigned char *p = (const unsigned char *)view.ptr;
+
+#if defined(C_STRING_HAVE_AVX2_DISPATCH)
+    if (view.len >= 32 && cs_cpu_has_avx2()) {
+        return utf8_validate_avx2(p, view.len);
+    }
+#endif
+    return utf8_validate_scalar(p, view.len);
+}
+
+bool string_utf8_validate(const String *string)
+{
+    return string_view_utf8_validate(string_view_from_string(string));
+}
+
+size_t string_view_utf8_length(StringView view)
+{
+    const unsigned char *p = (const unsigned char *)view.ptr;
+    size_t count = 0;
+    size_t i = 0;
+
+#ifdef C_STRING_HAVE_SSE2
+    // Continuation bytes are 0x80..0xBF, i.e. -128..-65 as signed bytes
+    const __m128i continuation_max = _mm_set1_epi8(-65);
+    for (; i + 16 <= view.len; i += 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i *)(p + i));
+        count += cs_popcount32((uint32_t)_mm_movemask_epi8(_mm_cmpgt_epi8(bytes, continuation_max)));
+    }
+#endif
+
+    for (; i < view.len; i++) {
+        count += (p[i] & 0xC0) != 0x80;
+    }
+    return count;
+}
+
+size_t string_utf8_length(const String *string)
+{
+    return string_view_utf8_length(string_view_from_string(string));
+}
+
+StringUtf8Iterator string_utf8_iterate(StringView view)
+{
+    StringUtf8Iterator it = { view };
+    return it;
+}
+
+bool string_utf8_next(StringUtf8Iterator *it, uint32_t *code_point)
+{
+    if (it->rest.len == 0) {
+        return false;
+    }
+
+    size_t prefix;
+    size_t n = utf8_decode((const unsigned char *)it->rest.ptr, it->rest.len, code_point, &prefix);
+    if (n == 0) {
+        *code_point = STRING_UTF8_REPLACEMENT;
+        n = prefix;
+    }
+
+    it->rest.ptr += n;
+    it->rest.len -= n;
+    return true;
+}